@@ -0,0 +1,194 @@
+#pragma once
+
+#include "vector.h"
+
+#include <cstdint>
+
+// Монотонная арена для короткоживущих данных (например, на время обработки одного запроса).
+// Выделение - сдвиг указателя внутри блока, освобождение отдельных участков ничего не делает,
+// вся память возвращается разом вызовом Reset. Блоки после Reset не освобождаются, а используются
+// повторно, так что в установившемся режиме арена не обращается к operator new вовсе
+class Arena {
+public:
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+    explicit Arena(size_t block_size = DEFAULT_BLOCK_SIZE) noexcept
+        : block_size_(block_size) {
+    }
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    ~Arena() {
+        while (first_ != nullptr) {
+            Block* next = first_->next;
+            ::operator delete(first_);
+            first_ = next;
+        }
+    }
+
+    void* Allocate(size_t bytes, size_t alignment) {
+        assert((alignment & (alignment - 1)) == 0);
+        if (void* p = AllocateInCurrent(bytes, alignment)) {
+            return p;
+        }
+        // Следующие блоки остались от прошлых циклов до Reset. Неподходящие по размеру пропускаются
+        while (current_ != nullptr && current_->next != nullptr) {
+            UseBlock(current_->next);
+            if (void* p = AllocateInCurrent(bytes, alignment)) {
+                return p;
+            }
+        }
+        // Размер нового блока не должен переполниться: иначе блок окажется меньше запроса
+        if (bytes > std::numeric_limits<size_t>::max() - sizeof(Block) - alignment) {
+            throw std::bad_alloc();
+        }
+        AppendBlock(std::max(block_size_, sizeof(Block) + bytes + alignment));
+        void* p = AllocateInCurrent(bytes, alignment);
+        if (p == nullptr) {
+            throw std::bad_alloc();
+        }
+        return p;
+    }
+
+    // Увеличивает последний выделенный участок на месте, если в блоке хватает места
+    bool TryExpand(void* p, size_t old_bytes, size_t new_bytes) noexcept {
+        char* end = static_cast<char*>(p) + old_bytes;
+        if (end != ptr_ || new_bytes < old_bytes || new_bytes - old_bytes > static_cast<size_t>(limit_ - ptr_)) {
+            return false;
+        }
+        ptr_ += new_bytes - old_bytes;
+        used_ += new_bytes - old_bytes;
+        return true;
+    }
+
+    // Делает всю выделенную память снова свободной. Объекты, размещённые в арене, должны быть
+    // разрушены раньше (у тривиально разрушаемых типов разрушение ничего не делает)
+    void Reset() noexcept {
+        used_ = 0;
+        if (first_ != nullptr) {
+            UseBlock(first_);
+        }
+    }
+
+    // Байт выделено с последнего Reset, включая выравнивание
+    size_t BytesUsed() const noexcept {
+        return used_;
+    }
+
+    // Байт занято блоками
+    size_t BytesReserved() const noexcept {
+        return reserved_;
+    }
+
+private:
+    struct alignas(std::max_align_t) Block {
+        Block* next;
+        size_t size;
+    };
+
+    size_t block_size_;
+    Block* first_ = nullptr;
+    Block* current_ = nullptr;
+    char* ptr_ = nullptr;
+    char* limit_ = nullptr;
+    size_t used_ = 0;
+    size_t reserved_ = 0;
+
+    void* AllocateInCurrent(size_t bytes, size_t alignment) noexcept {
+        if (ptr_ == nullptr) {
+            return nullptr;
+        }
+        const uintptr_t address = reinterpret_cast<uintptr_t>(ptr_);
+        const size_t padding = ((address + alignment - 1) & ~(alignment - 1)) - address;
+        if (padding > static_cast<size_t>(limit_ - ptr_) || bytes > static_cast<size_t>(limit_ - ptr_) - padding) {
+            return nullptr;
+        }
+        char* p = ptr_ + padding;
+        ptr_ = p + bytes;
+        used_ += padding + bytes;
+        return p;
+    }
+
+    void UseBlock(Block* block) noexcept {
+        current_ = block;
+        ptr_ = reinterpret_cast<char*>(block + 1);
+        limit_ = reinterpret_cast<char*>(block) + block->size;
+    }
+
+    // Новый блок вставляется сразу за текущим
+    void AppendBlock(size_t size) {
+        Block* block = static_cast<Block*>(::operator new(size));
+        block->size = size;
+        if (current_ == nullptr) {
+            block->next = first_;
+            first_ = block;
+        }
+        else {
+            block->next = current_->next;
+            current_->next = block;
+        }
+        reserved_ += size;
+        UseBlock(block);
+    }
+};
+
+// Аллокатор для Vector и других контейнеров, размещающий память в арене. deallocate ничего
+// не делает. Рост последнего выделенного буфера идёт на месте через try_expand.
+// Арена должна жить дольше всех контейнеров, использующих её
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = ArenaAllocator<U>;
+    };
+
+    explicit ArenaAllocator(Arena& arena) noexcept
+        : arena_(&arena) {
+    }
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept
+        : arena_(&other.GetArena()) {
+    }
+
+    Arena& GetArena() const noexcept {
+        return *arena_;
+    }
+
+    T* allocate(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(arena_->Allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* /*p*/, size_t /*n*/) noexcept {
+    }
+
+    bool try_expand(T* p, size_t old_n, size_t new_n) noexcept {
+        if (new_n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            return false;
+        }
+        return arena_->TryExpand(p, old_n * sizeof(T), new_n * sizeof(T));
+    }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const noexcept {
+        return arena_ == &other.GetArena();
+    }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const noexcept {
+        return !(*this == other);
+    }
+
+private:
+    Arena* arena_;
+};
+
+// Vector, размещённый в арене
+template <typename T, typename Growth = DoublingGrowth>
+using ArenaVector = Vector<T, ArenaAllocator<T>, Growth>;
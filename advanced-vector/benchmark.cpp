@@ -0,0 +1,430 @@
+// Сравнительный бенчмарк Vector и std::vector.
+// Сборка: g++ -std=c++17 -O2 -DNDEBUG benchmark.cpp -o benchmark
+// Запуск: ./benchmark [--max-size=N] [--types=trivial,string,move_only]
+//                     [--ops=push_back,emplace_back,insert,erase,reserve,resize,copy_assign] [--format=csv|json]
+// Каждая строка вывода описывает один замер: контейнер, тип элементов, операцию, размер,
+// время на операцию, число и объём выделений памяти на один прогон и пиковое RSS процесса за замер
+
+#include "vector.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <sys/resource.h>
+
+namespace {
+
+    size_t g_allocations = 0;
+    size_t g_allocated_bytes = 0;
+
+}  // namespace
+
+void* operator new(size_t size) {
+    ++g_allocations;
+    g_allocated_bytes += size;
+    if (void* p = std::malloc(size != 0 ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    ++g_allocations;
+    g_allocated_bytes += size;
+    const size_t align = static_cast<size_t>(alignment);
+    if (void* p = std::aligned_alloc(align, (size + align - 1) / align * align)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+// GCC не видит, что замещённый operator new сам вызывает malloc, и ошибочно считает free несовместимым
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    // Не даёт компилятору выбросить вычисления, результат которых не используется
+    template <typename Container>
+    void DoNotOptimize(const Container& container) {
+        const void* p = &*container.begin();
+        asm volatile("" : : "g"(p) : "memory");
+    }
+
+    // Сбрасывает пиковое RSS процесса (VmHWM), чтобы измерять пик отдельного замера. Доступно в Linux
+    void ResetPeakRss() {
+        std::ofstream("/proc/self/clear_refs") << "5";
+    }
+
+    size_t PeakRssKb() {
+        std::ifstream status("/proc/self/status");
+        std::string line;
+        while (std::getline(status, line)) {
+            if (line.rfind("VmHWM:", 0) == 0) {
+                return std::stoul(line.substr(6));
+            }
+        }
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+        return static_cast<size_t>(usage.ru_maxrss);
+    }
+
+    // Значения для разных типов элементов. Строки длиннее SSO-буфера, чтобы копирование выделяло память
+    template <typename T>
+    T MakeValue(size_t i);
+
+    template <>
+    int64_t MakeValue<int64_t>(size_t i) {
+        return static_cast<int64_t>(i);
+    }
+
+    template <>
+    std::string MakeValue<std::string>(size_t i) {
+        std::string value = std::to_string(i);
+        value.resize(32, '#');
+        return value;
+    }
+
+    template <>
+    std::unique_ptr<int64_t> MakeValue<std::unique_ptr<int64_t>>(size_t i) {
+        return std::make_unique<int64_t>(static_cast<int64_t>(i));
+    }
+
+    // Единый интерфейс к сравниваемым контейнерам
+    template <typename T>
+    struct StdVectorApi {
+        using Container = std::vector<T>;
+        static constexpr std::string_view NAME = "std::vector";
+
+        static void PushBack(Container& v, T value) {
+            v.push_back(std::move(value));
+        }
+        template <typename... Args>
+        static void EmplaceBack(Container& v, Args&&... args) {
+            v.emplace_back(std::forward<Args>(args)...);
+        }
+        static void InsertMiddle(Container& v, T value) {
+            v.insert(v.begin() + v.size() / 2, std::move(value));
+        }
+        static void EraseMiddle(Container& v) {
+            v.erase(v.begin() + v.size() / 2);
+        }
+        static void Reserve(Container& v, size_t n) {
+            v.reserve(n);
+        }
+        static void Resize(Container& v, size_t n) {
+            v.resize(n);
+        }
+    };
+
+    template <typename T>
+    struct VectorApi {
+        using Container = Vector<T>;
+        static constexpr std::string_view NAME = "Vector";
+
+        static void PushBack(Container& v, T value) {
+            v.PushBack(std::move(value));
+        }
+        template <typename... Args>
+        static void EmplaceBack(Container& v, Args&&... args) {
+            v.EmplaceBack(std::forward<Args>(args)...);
+        }
+        static void InsertMiddle(Container& v, T value) {
+            v.Insert(v.begin() + v.Size() / 2, std::move(value));
+        }
+        static void EraseMiddle(Container& v) {
+            v.Erase(v.begin() + v.Size() / 2);
+        }
+        static void Reserve(Container& v, size_t n) {
+            v.Reserve(n);
+        }
+        static void Resize(Container& v, size_t n) {
+            v.Resize(n);
+        }
+    };
+
+    struct Options {
+        size_t max_size = 100'000'000;
+        bool json = false;
+        std::vector<std::string> types{ "trivial", "string", "move_only" };
+        std::vector<std::string> ops{ "push_back", "emplace_back", "insert", "erase", "reserve", "resize", "copy_assign" };
+
+        bool HasType(std::string_view type) const {
+            return std::find(types.begin(), types.end(), type) != types.end();
+        }
+        bool HasOp(std::string_view op) const {
+            return std::find(ops.begin(), ops.end(), op) != ops.end();
+        }
+    };
+
+    struct Measurement {
+        double ns_per_op = 0;
+        size_t allocations = 0;
+        size_t allocated_bytes = 0;
+        size_t peak_rss_kb = 0;
+    };
+
+    void Report(const Options& options, std::string_view container, std::string_view type, std::string_view op,
+                size_t size, const Measurement& m) {
+        if (options.json) {
+            std::printf("{\"container\":\"%s\",\"type\":\"%s\",\"op\":\"%s\",\"size\":%zu,\"ns_per_op\":%.3f,"
+                        "\"allocations\":%zu,\"allocated_bytes\":%zu,\"peak_rss_kb\":%zu}\n",
+                        std::string(container).c_str(), std::string(type).c_str(), std::string(op).c_str(), size,
+                        m.ns_per_op, m.allocations, m.allocated_bytes, m.peak_rss_kb);
+        }
+        else {
+            std::printf("%s,%s,%s,%zu,%.3f,%zu,%zu,%zu\n", std::string(container).c_str(), std::string(type).c_str(),
+                        std::string(op).c_str(), size, m.ns_per_op, m.allocations, m.allocated_bytes, m.peak_rss_kb);
+        }
+        std::fflush(stdout);
+    }
+
+    // Накапливает время и выделения памяти на отрезках между Start() и Stop()
+    class Timer {
+    public:
+        void Start() {
+            allocations_ = g_allocations;
+            allocated_bytes_ = g_allocated_bytes;
+            start_ = Clock::now();
+        }
+        void Stop() {
+            elapsed_ += Clock::now() - start_;
+            allocations_total_ += g_allocations - allocations_;
+            allocated_bytes_total_ += g_allocated_bytes - allocated_bytes_;
+        }
+
+        Measurement Result(size_t repetitions, size_t ops_per_repetition) const {
+            Measurement m;
+            m.ns_per_op = std::chrono::duration<double, std::nano>(elapsed_).count()
+                / static_cast<double>(repetitions * ops_per_repetition);
+            m.allocations = allocations_total_ / repetitions;
+            m.allocated_bytes = allocated_bytes_total_ / repetitions;
+            m.peak_rss_kb = PeakRssKb();
+            return m;
+        }
+
+    private:
+        Clock::time_point start_;
+        Clock::duration elapsed_{};
+        size_t allocations_ = 0;
+        size_t allocated_bytes_ = 0;
+        size_t allocations_total_ = 0;
+        size_t allocated_bytes_total_ = 0;
+    };
+
+    // work_per_repetition - примерное число элементарных действий (конструирований, сдвигов) за прогон.
+    // Дешёвые прогоны повторяются, чтобы суммарная работа замера была не меньше ~10^6 действий
+    size_t Repetitions(size_t work_per_repetition) {
+        return std::max<size_t>(1, 1'000'000 / std::max<size_t>(work_per_repetition, 1));
+    }
+
+    // Для операций с подготовкой вне замера: каждый прогон сам вызывает timer.Start() и timer.Stop()
+    template <typename Api>
+    void RunCase(const Options& options, std::string_view type, std::string_view op, size_t size,
+                 size_t ops_per_repetition, size_t work_per_repetition, const std::function<void(Timer&)>& run) {
+        const size_t repetitions = Repetitions(work_per_repetition);
+        ResetPeakRss();
+        Timer timer;
+        for (size_t rep = 0; rep < repetitions; ++rep) {
+            run(timer);
+        }
+        Report(options, Api::NAME, type, op, size, timer.Result(repetitions, ops_per_repetition));
+    }
+
+    // Для операций без подготовки: замеряется весь цикл прогонов. При малых размерах пара вызовов
+    // часов на каждый прогон стоила бы дороже самой операции
+    template <typename Api, typename F>
+    void RunLoopCase(const Options& options, std::string_view type, std::string_view op, size_t size,
+                     size_t ops_per_repetition, size_t work_per_repetition, F run) {
+        const size_t repetitions = Repetitions(work_per_repetition);
+        ResetPeakRss();
+        Timer timer;
+        timer.Start();
+        for (size_t rep = 0; rep < repetitions; ++rep) {
+            run();
+        }
+        timer.Stop();
+        Report(options, Api::NAME, type, op, size, timer.Result(repetitions, ops_per_repetition));
+    }
+
+    template <typename Api, typename T>
+    void RunContainer(const Options& options, std::string_view type, size_t size) {
+        using Container = typename Api::Container;
+
+        if (options.HasOp("push_back")) {
+            RunLoopCase<Api>(options, type, "push_back", size, size, size, [size] {
+                Container v;
+                for (size_t i = 0; i < size; ++i) {
+                    Api::PushBack(v, MakeValue<T>(i));
+                }
+                DoNotOptimize(v);
+            });
+        }
+        if (options.HasOp("emplace_back")) {
+            RunLoopCase<Api>(options, type, "emplace_back", size, size, size, [size] {
+                Container v;
+                for (size_t i = 0; i < size; ++i) {
+                    Api::EmplaceBack(v, MakeValue<T>(i));
+                }
+                DoNotOptimize(v);
+            });
+        }
+        if (options.HasOp("reserve")) {
+            RunLoopCase<Api>(options, type, "reserve", size, size, size, [size] {
+                Container v;
+                Api::Reserve(v, size);
+                for (size_t i = 0; i < size; ++i) {
+                    Api::PushBack(v, MakeValue<T>(i));
+                }
+                DoNotOptimize(v);
+            });
+        }
+        if (options.HasOp("resize")) {
+            RunLoopCase<Api>(options, type, "resize", size, size, size, [size] {
+                Container v;
+                Api::Resize(v, size);
+                DoNotOptimize(v);
+            });
+        }
+
+        // Вставка и удаление в середине сдвигают половину вектора, поэтому их число ограничено так,
+        // чтобы один прогон сдвигал не больше ~10^9 элементов, а размер вектора менялся не более чем вдвое
+        const size_t middle_ops = std::max<size_t>(1, std::min<size_t>({ size, 1000, 1'000'000'000 / size }));
+        if (options.HasOp("insert")) {
+            RunCase<Api>(options, type, "insert", size, middle_ops, size * (middle_ops + 1), [size, middle_ops](Timer& timer) {
+                Container v;
+                for (size_t i = 0; i < size; ++i) {
+                    Api::PushBack(v, MakeValue<T>(i));
+                }
+                timer.Start();
+                for (size_t i = 0; i < middle_ops; ++i) {
+                    Api::InsertMiddle(v, MakeValue<T>(i));
+                }
+                DoNotOptimize(v);
+                timer.Stop();
+            });
+        }
+        if (options.HasOp("erase")) {
+            RunCase<Api>(options, type, "erase", size, middle_ops, size * (middle_ops + 1), [size, middle_ops](Timer& timer) {
+                Container v;
+                for (size_t i = 0; i < size + middle_ops; ++i) {
+                    Api::PushBack(v, MakeValue<T>(i));
+                }
+                timer.Start();
+                for (size_t i = 0; i < middle_ops; ++i) {
+                    Api::EraseMiddle(v);
+                }
+                DoNotOptimize(v);
+                timer.Stop();
+            });
+        }
+        if constexpr (std::is_copy_assignable_v<T>) {
+            if (options.HasOp("copy_assign")) {
+                RunCase<Api>(options, type, "copy_assign", size, size, size, [size](Timer& timer) {
+                    Container source;
+                    for (size_t i = 0; i < size; ++i) {
+                        Api::PushBack(source, MakeValue<T>(i));
+                    }
+                    Container target;
+                    timer.Start();
+                    target = source;
+                    DoNotOptimize(target);
+                    timer.Stop();
+                });
+            }
+        }
+    }
+
+    template <typename T>
+    void RunType(const Options& options, std::string_view type) {
+        if (!options.HasType(type)) {
+            return;
+        }
+        for (size_t size = 1; size <= options.max_size; size *= 10) {
+            RunContainer<StdVectorApi<T>, T>(options, type, size);
+            RunContainer<VectorApi<T>, T>(options, type, size);
+        }
+    }
+
+    std::vector<std::string> SplitList(std::string_view list) {
+        std::vector<std::string> items;
+        while (!list.empty()) {
+            const size_t comma = list.find(',');
+            items.emplace_back(list.substr(0, comma));
+            list.remove_prefix(comma == std::string_view::npos ? list.size() : comma + 1);
+        }
+        return items;
+    }
+
+    Options ParseOptions(int argc, char* argv[]) {
+        using namespace std::literals;
+        Options options;
+        for (int i = 1; i < argc; ++i) {
+            const std::string_view arg = argv[i];
+            if (arg.rfind("--max-size="sv, 0) == 0) {
+                options.max_size = std::stoull(std::string(arg.substr("--max-size="sv.size())));
+            }
+            else if (arg.rfind("--types="sv, 0) == 0) {
+                options.types = SplitList(arg.substr("--types="sv.size()));
+            }
+            else if (arg.rfind("--ops="sv, 0) == 0) {
+                options.ops = SplitList(arg.substr("--ops="sv.size()));
+            }
+            else if (arg == "--format=json"sv) {
+                options.json = true;
+            }
+            else if (arg != "--format=csv"sv) {
+                throw std::invalid_argument("unknown option: "s + argv[i]);
+            }
+        }
+        return options;
+    }
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    try {
+        const Options options = ParseOptions(argc, argv);
+        if (!options.json) {
+            std::printf("container,type,op,size,ns_per_op,allocations,allocated_bytes,peak_rss_kb\n");
+        }
+        RunType<int64_t>(options, "trivial");
+        RunType<std::string>(options, "string");
+        RunType<std::unique_ptr<int64_t>>(options, "move_only");
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
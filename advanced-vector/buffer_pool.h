@@ -0,0 +1,297 @@
+#pragma once
+
+#include "vector.h"
+
+#include <atomic>
+#include <mutex>
+
+// Пул освобождённых буферов по классам размера - степеням двойки. Рост удвоением даёт одни и те же
+// размеры буферов, поэтому буфер, освобождённый одним вектором, подходит следующему Reserve.
+//
+// У каждого потока свой кеш: не больше нескольких буферов на класс, без блокировок. Излишки кеша
+// и буферы, оставшиеся после завершения потока, уходят в общий пул под мьютексом, тоже ограниченный.
+// Только когда пусто и там, память берётся у operator new; буферы больше MAX_POOLED_BYTES не кешируются
+class BufferPool {
+public:
+    static constexpr size_t MIN_CLASS_SHIFT = 4;
+    static constexpr size_t MAX_CLASS_SHIFT = 22;
+    static constexpr size_t MAX_POOLED_BYTES = size_t{ 1 } << MAX_CLASS_SHIFT;
+    // Объём памяти, который кеш потока держит в одном классе
+    static constexpr size_t LOCAL_BYTES_PER_CLASS = 256 * 1024;
+    static constexpr size_t MAX_LOCAL_BUFFERS = 32;
+    static constexpr size_t SHARED_TO_LOCAL_RATIO = 4;
+
+    // Обращения к operator new и operator delete мимо пула
+    struct Stats {
+        size_t system_allocations = 0;
+        size_t system_deallocations = 0;
+    };
+
+    // Размер буфера, который на самом деле выдаётся на запрос в bytes байт
+    static constexpr size_t UsableSize(size_t bytes) noexcept {
+        return bytes > MAX_POOLED_BYTES ? bytes : ClassBytes(ClassOf(bytes));
+    }
+
+    static void* Allocate(size_t bytes) {
+        if (bytes > MAX_POOLED_BYTES) {
+            return SystemAllocate(bytes);
+        }
+        const size_t cls = ClassOf(bytes);
+        LocalCache& local = Local();
+        if (local.heads[cls] == nullptr && !local.dead) {
+            GetShared().Refill(local, cls);
+        }
+        if (FreeNode* node = local.heads[cls]) {
+            local.heads[cls] = node->next;
+            --local.counts[cls];
+            return node;
+        }
+        return SystemAllocate(ClassBytes(cls));
+    }
+
+    // bytes - размер, с которым буфер был запрошен (или любой до UsableSize от него)
+    static void Deallocate(void* p, size_t bytes) noexcept {
+        if (p == nullptr) {
+            return;
+        }
+        if (bytes > MAX_POOLED_BYTES) {
+            SystemDeallocate(p);
+            return;
+        }
+        const size_t cls = ClassOf(bytes);
+        LocalCache& local = Local();
+        if (local.dead) {
+            // Кеш потока уже сброшен при завершении потока
+            GetShared().PutOrFree(static_cast<FreeNode*>(p), cls);
+            return;
+        }
+        if (local.counts[cls] == LocalLimit(cls)) {
+            GetShared().Spill(local, cls);
+        }
+        auto* node = static_cast<FreeNode*>(p);
+        node->next = local.heads[cls];
+        local.heads[cls] = node;
+        ++local.counts[cls];
+    }
+
+    static Stats GetStats() noexcept {
+        return Stats{ Counters().allocations.load(std::memory_order_relaxed),
+                      Counters().deallocations.load(std::memory_order_relaxed) };
+    }
+
+    // Возвращает системе все буферы кеша текущего потока и общего пула
+    static void Trim() noexcept {
+        LocalCache& local = Local();
+        for (size_t cls = 0; cls < CLASSES; ++cls) {
+            FreeAll(local.heads[cls]);
+            local.heads[cls] = nullptr;
+            local.counts[cls] = 0;
+        }
+        GetShared().Trim();
+    }
+
+private:
+    static constexpr size_t CLASSES = MAX_CLASS_SHIFT - MIN_CLASS_SHIFT + 1;
+
+    struct FreeNode {
+        FreeNode* next;
+    };
+
+    // Тривиально разрушаемый, чтобы оставаться доступным после деструкторов thread_local объектов
+    struct LocalCache {
+        FreeNode* heads[CLASSES];
+        size_t counts[CLASSES];
+        bool dead;
+    };
+
+    struct SystemCounters {
+        std::atomic<size_t> allocations{ 0 };
+        std::atomic<size_t> deallocations{ 0 };
+    };
+
+    class SharedPool {
+    public:
+        // Забирает в пустой кеш потока до половины его лимита
+        void Refill(LocalCache& local, size_t cls) noexcept {
+            std::lock_guard lock(mutex_);
+            for (size_t n = std::max<size_t>(1, LocalLimit(cls) / 2); n > 0 && heads_[cls] != nullptr; --n) {
+                FreeNode* node = heads_[cls];
+                heads_[cls] = node->next;
+                --counts_[cls];
+                node->next = local.heads[cls];
+                local.heads[cls] = node;
+                ++local.counts[cls];
+            }
+        }
+
+        // Переносит половину заполненного кеша потока в общий пул, излишек возвращает системе
+        void Spill(LocalCache& local, size_t cls) noexcept {
+            FreeNode* overflow = nullptr;
+            {
+                std::lock_guard lock(mutex_);
+                for (size_t n = std::max<size_t>(1, local.counts[cls] / 2); n > 0; --n) {
+                    FreeNode* node = local.heads[cls];
+                    local.heads[cls] = node->next;
+                    --local.counts[cls];
+                    if (counts_[cls] < SharedLimit(cls)) {
+                        node->next = heads_[cls];
+                        heads_[cls] = node;
+                        ++counts_[cls];
+                    }
+                    else {
+                        node->next = overflow;
+                        overflow = node;
+                    }
+                }
+            }
+            FreeAll(overflow);
+        }
+
+        void PutOrFree(FreeNode* node, size_t cls) noexcept {
+            {
+                std::lock_guard lock(mutex_);
+                if (counts_[cls] < SharedLimit(cls)) {
+                    node->next = heads_[cls];
+                    heads_[cls] = node;
+                    ++counts_[cls];
+                    return;
+                }
+            }
+            SystemDeallocate(node);
+        }
+
+        void Trim() noexcept {
+            FreeNode* lists[CLASSES];
+            {
+                std::lock_guard lock(mutex_);
+                for (size_t cls = 0; cls < CLASSES; ++cls) {
+                    lists[cls] = std::exchange(heads_[cls], nullptr);
+                    counts_[cls] = 0;
+                }
+            }
+            for (FreeNode* list : lists) {
+                FreeAll(list);
+            }
+        }
+
+    private:
+        std::mutex mutex_;
+        FreeNode* heads_[CLASSES] = {};
+        size_t counts_[CLASSES] = {};
+    };
+
+    // При завершении потока отдаёт его кеш в общий пул
+    struct LocalFlusher {
+        ~LocalFlusher() {
+            LocalCache& local = Local();
+            local.dead = true;
+            for (size_t cls = 0; cls < CLASSES; ++cls) {
+                while (FreeNode* node = local.heads[cls]) {
+                    local.heads[cls] = node->next;
+                    GetShared().PutOrFree(node, cls);
+                }
+                local.counts[cls] = 0;
+            }
+        }
+    };
+
+    static constexpr size_t ClassOf(size_t bytes) noexcept {
+        size_t cls = 0;
+        while ((size_t{ 1 } << (cls + MIN_CLASS_SHIFT)) < bytes) {
+            ++cls;
+        }
+        return cls;
+    }
+
+    static constexpr size_t ClassBytes(size_t cls) noexcept {
+        return size_t{ 1 } << (cls + MIN_CLASS_SHIFT);
+    }
+
+    static constexpr size_t LocalLimit(size_t cls) noexcept {
+        return std::clamp<size_t>(LOCAL_BYTES_PER_CLASS / ClassBytes(cls), 1, MAX_LOCAL_BUFFERS);
+    }
+
+    static constexpr size_t SharedLimit(size_t cls) noexcept {
+        return LocalLimit(cls) * SHARED_TO_LOCAL_RATIO;
+    }
+
+    static LocalCache& Local() noexcept {
+        static thread_local LocalCache cache{};
+        static thread_local LocalFlusher flusher;
+        (void)flusher;
+        return cache;
+    }
+
+    // Общий пул не разрушается: буферы могут освобождаться из деструкторов статических объектов
+    static SharedPool& GetShared() noexcept {
+        static SharedPool* shared = new SharedPool();
+        return *shared;
+    }
+
+    static SystemCounters& Counters() noexcept {
+        static SystemCounters counters;
+        return counters;
+    }
+
+    static void* SystemAllocate(size_t bytes) {
+        void* p = ::operator new(bytes);
+        Counters().allocations.fetch_add(1, std::memory_order_relaxed);
+        return p;
+    }
+
+    static void SystemDeallocate(void* p) noexcept {
+        Counters().deallocations.fetch_add(1, std::memory_order_relaxed);
+        ::operator delete(p);
+    }
+
+    static void FreeAll(FreeNode* list) noexcept {
+        while (list != nullptr) {
+            FreeNode* next = list->next;
+            SystemDeallocate(list);
+            list = next;
+        }
+    }
+};
+
+// Аллокатор, берущий буферы из BufferPool. Без состояния, все экземпляры равны.
+// Буфер округляется до класса размера, и рост в пределах класса идёт на месте через try_expand
+template <typename T>
+struct PooledAllocator {
+    static_assert(alignof(T) <= alignof(std::max_align_t), "BufferPool buffers are aligned to max_align_t");
+
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    PooledAllocator() noexcept = default;
+
+    template <typename U>
+    PooledAllocator(const PooledAllocator<U>&) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(BufferPool::Allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        BufferPool::Deallocate(p, n * sizeof(T));
+    }
+
+    bool try_expand(T* /*p*/, size_t old_n, size_t new_n) noexcept {
+        return new_n <= BufferPool::UsableSize(old_n * sizeof(T)) / sizeof(T);
+    }
+
+    template <typename U>
+    bool operator==(const PooledAllocator<U>&) const noexcept {
+        return true;
+    }
+    template <typename U>
+    bool operator!=(const PooledAllocator<U>&) const noexcept {
+        return false;
+    }
+};
+
+template <typename T, typename Growth = DoublingGrowth>
+using PooledVector = Vector<T, PooledAllocator<T>, Growth>;
@@ -0,0 +1,244 @@
+#pragma once
+
+#include "vector.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Вектор с добавлением в конец из нескольких потоков без блокировок. Элементы хранятся в сегментах
+// RawMemory, сегмент s вмещает 2^(FirstShift + s) элементов, поэтому сегментов немного, а уже
+// созданные элементы никогда не переносятся. Позиция резервируется атомарным fetch_add по счётчику,
+// элемент конструируется в своей ячейке без синхронизации с остальными писателями.
+//
+// Читатели видят только опубликованные элементы: Size() - длина непрерывного префикса полностью
+// созданных элементов. Каждый писатель отмечает свою ячейку в битовой карте сегмента. Если граница
+// префикса ещё не дошла до его ячейки, а перед ней несозданный элемент, писатель сразу уходит.
+// Писатель, закрывший разрыв, одним CAS переносит границу через все готовые ячейки за ним, поэтому
+// граница сдвигается пачками, а не каждым писателем по одной ячейке. Отставший писатель не блокирует
+// остальных, его элемент и следующие за ним будут опубликованы, когда он закончит.
+//
+// Разрушение, перемещение и копирование контейнера не потокобезопасны
+template <typename T, size_t FirstShift = 6, typename Alloc = std::allocator<T>>
+class ConcurrentVector {
+    static_assert(FirstShift < sizeof(size_t) * 8, "first segment size does not fit into size_t");
+
+    struct Segment {
+        Segment(size_t size, const Alloc& alloc)
+            : data(size, alloc)
+            , ready(new std::atomic<uint64_t>[(size + 63) / 64]()) {
+        }
+
+        RawMemory<T, Alloc> data;
+        std::unique_ptr<std::atomic<uint64_t>[]> ready;
+    };
+
+public:
+    using allocator_type = Alloc;
+
+    static constexpr size_t FIRST_SEGMENT_SIZE = size_t{ 1 } << FirstShift;
+    static constexpr size_t MAX_SEGMENTS = sizeof(size_t) * 8 - FirstShift;
+
+    ConcurrentVector() = default;
+
+    explicit ConcurrentVector(const Alloc& alloc)
+        : alloc_(alloc) {
+    }
+
+    ConcurrentVector(const ConcurrentVector&) = delete;
+    ConcurrentVector& operator=(const ConcurrentVector&) = delete;
+
+    // Разрушаются все созданные элементы, в том числе неопубликованные за позицией, для которой
+    // не удалось выделить сегмент
+    ~ConcurrentVector() {
+        for (size_t segment = 0; segment < MAX_SEGMENTS; ++segment) {
+            Segment* seg = segments_[segment].load(std::memory_order_relaxed);
+            if (seg == nullptr) {
+                continue;
+            }
+            const size_t words = ((FIRST_SEGMENT_SIZE << segment) + 63) / 64;
+            for (size_t word = 0; word < words; ++word) {
+                for (uint64_t bits = seg->ready[word].load(std::memory_order_relaxed); bits != 0; bits &= bits - 1) {
+                    std::destroy_at(seg->data + (word * 64 + CountTrailingZeros(bits)));
+                }
+            }
+            delete seg;
+        }
+    }
+
+    // Количество опубликованных элементов. Элементы с меньшими индексами можно читать из любого потока
+    size_t Size() const noexcept {
+        return size_.load(std::memory_order_acquire);
+    }
+
+    // Заранее выделяет сегменты под capacity элементов. Можно вызывать одновременно с EmplaceBack
+    void Reserve(size_t capacity) {
+        if (capacity == 0) {
+            return;
+        }
+        for (size_t segment = 0, last = SegmentOf(capacity - 1); segment <= last; ++segment) {
+            GetOrCreateSegment(segment);
+        }
+    }
+
+    template <typename Type>
+    size_t PushBack(Type&& value) {
+        return EmplaceBack(std::forward<Type>(value));
+    }
+
+    // Создаёт элемент в конце и возвращает его индекс. Элемент становится виден читателям, когда
+    // опубликованы все элементы перед ним. Если конструктор может выбросить исключение, значение
+    // создаётся до резервирования позиции и затем перемещается, чтобы не оставлять в векторе дыр
+    template <typename... Args>
+    size_t EmplaceBack(Args&&... args) {
+        if constexpr (std::is_nothrow_constructible_v<T, Args...>) {
+            return EmplaceReserved(std::forward<Args>(args)...);
+        }
+        else {
+            static_assert(std::is_nothrow_move_constructible_v<T>,
+                          "ConcurrentVector requires a non-throwing constructor or move constructor");
+            T value(std::forward<Args>(args)...);
+            return EmplaceReserved(std::move(value));
+        }
+    }
+
+    // index должен быть меньше ранее прочитанного Size()
+    T& operator[](size_t index) noexcept {
+        VECTOR_CHECK(index < Size());
+        const size_t segment = SegmentOf(index);
+        return segments_[segment].load(std::memory_order_acquire)->data[index - SegmentBegin(segment)];
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<ConcurrentVector&>(*this)[index];
+    }
+
+    // Вызывает f(T* data, size_t count) для непрерывных участков опубликованного префикса по порядку
+    template <typename F>
+    void ForEachChunk(F f) {
+        const size_t size = Size();
+        for (size_t segment = 0; SegmentBegin(segment) < size; ++segment) {
+            const size_t begin = SegmentBegin(segment);
+            f(segments_[segment].load(std::memory_order_acquire)->data.GetAddress(),
+              std::min(size, SegmentBegin(segment + 1)) - begin);
+        }
+    }
+
+    template <typename F>
+    void ForEachChunk(F f) const {
+        const_cast<ConcurrentVector&>(*this).ForEachChunk([&f](const T* data, size_t count) {
+            f(data, count);
+        });
+    }
+
+private:
+    std::array<std::atomic<Segment*>, MAX_SEGMENTS> segments_{};
+    // Счётчики на разных кэш-линиях: резервирование и публикация не мешают друг другу
+    alignas(CACHE_LINE_ALIGNMENT) std::atomic<size_t> reserved_{ 0 };
+    alignas(CACHE_LINE_ALIGNMENT) std::atomic<size_t> size_{ 0 };
+    [[no_unique_address]] Alloc alloc_;
+
+    static size_t HighestBit(size_t value) noexcept {
+#if defined(__GNUC__)
+        return sizeof(unsigned long long) * 8 - 1 - __builtin_clzll(value);
+#else
+        size_t bit = 0;
+        while (value >>= 1) {
+            ++bit;
+        }
+        return bit;
+#endif
+    }
+
+    // value != 0
+    static size_t CountTrailingZeros(uint64_t value) noexcept {
+#if defined(__GNUC__)
+        return __builtin_ctzll(value);
+#else
+        size_t bit = 0;
+        while ((value & 1) == 0) {
+            value >>= 1;
+            ++bit;
+        }
+        return bit;
+#endif
+    }
+
+    // Сегмент s занимает индексы [FIRST * (2^s - 1), FIRST * (2^(s+1) - 1))
+    static size_t SegmentOf(size_t index) noexcept {
+        return HighestBit(index + FIRST_SEGMENT_SIZE) - FirstShift;
+    }
+
+    static size_t SegmentBegin(size_t segment) noexcept {
+        return (FIRST_SEGMENT_SIZE << segment) - FIRST_SEGMENT_SIZE;
+    }
+
+    // Первый писатель, попавший в невыделенный сегмент, выделяет его. При гонке проигравший
+    // освобождает свою копию и использует опубликованную
+    Segment* GetOrCreateSegment(size_t segment) {
+        Segment* existing = segments_[segment].load(std::memory_order_acquire);
+        if (existing != nullptr) {
+            return existing;
+        }
+        auto* created = new Segment(FIRST_SEGMENT_SIZE << segment, alloc_);
+        if (segments_[segment].compare_exchange_strong(existing, created, std::memory_order_acq_rel)) {
+            return created;
+        }
+        delete created;
+        return existing;
+    }
+
+    // Если выделение сегмента выбросит bad_alloc, зарезервированная позиция останется пустой,
+    // и последующие элементы не будут опубликованы. Reserve позволяет выделить память заранее
+    template <typename... Args>
+    size_t EmplaceReserved(Args&&... args) {
+        const size_t index = reserved_.fetch_add(1, std::memory_order_relaxed);
+        const size_t segment = SegmentOf(index);
+        Segment* seg = GetOrCreateSegment(segment);
+        const size_t offset = index - SegmentBegin(segment);
+
+        new (seg->data + offset) T(std::forward<Args>(args)...);
+        seg->ready[offset / 64].fetch_or(uint64_t{ 1 } << (offset % 64));
+        Publish(index);
+        return index;
+    }
+
+    // Первая неготовая ячейка начиная с index. Готовые ячейки пропускаются словами битовой карты
+    size_t FirstUnready(size_t index) const noexcept {
+        for (;;) {
+            const size_t segment = SegmentOf(index);
+            const Segment* seg = segments_[segment].load(std::memory_order_acquire);
+            if (seg == nullptr) {
+                return index;
+            }
+            const size_t segment_size = FIRST_SEGMENT_SIZE << segment;
+            for (size_t offset = index - SegmentBegin(segment); offset < segment_size;) {
+                const size_t shift = offset % 64;
+                const uint64_t unready = ~(seg->ready[offset / 64].load() >> shift);
+                // Сдвиг заполняет старшие биты нулями, поэтому серия обрывается не дальше конца слова
+                const size_t run = unready == 0 ? 64 : CountTrailingZeros(unready);
+                offset += run;
+                index += run;
+                // Биты за концом сегмента не отмечаются, так что offset не выходит за segment_size
+                if (run < 64 - shift && offset < segment_size) {
+                    return index;
+                }
+            }
+        }
+    }
+
+    // Отметка ячейки и чтение границы используют seq_cst: либо этот писатель увидит, что граница
+    // подошла к его ячейке, либо писатель, закрывающий разрыв перед ней, увидит отметку. Поэтому
+    // готовый элемент не может остаться неопубликованным. Граница переносится одним CAS через все
+    // готовые ячейки; неудача означает, что её сдвинул другой писатель, и проверка повторяется
+    void Publish(size_t index) noexcept {
+        size_t size = size_.load();
+        while (size <= index) {
+            const size_t end = FirstUnready(size);
+            // При неудаче compare_exchange_weak загружает в size актуальную границу
+            if (end == size || size_.compare_exchange_weak(size, end)) {
+                return;
+            }
+        }
+    }
+};
@@ -0,0 +1,650 @@
+#pragma once
+
+#include "vector.h"
+
+#include <functional>
+#include <stdexcept>
+#include <tuple>
+
+// Способ поиска ключа в FlatMap и FlatSet.
+//   SORTED    - двоичный поиск без ветвлений по отсортированным ключам;
+//   EYTZINGER - дополнительная копия ключей в порядке обхода дерева поиска в ширину (раскладка Эйтцингера):
+//               первые уровни дерева лежат в нескольких кеш-линиях, и следующий шаг поиска предсказуем
+//               для предвыборки. Индекс перестраивается за O(n) при каждом изменении, поэтому раскладка
+//               подходит для таблиц, которые почти не меняются после заполнения
+enum class FlatLayout {
+    SORTED,
+    EYTZINGER,
+};
+
+namespace flat_detail {
+
+    // Первая позиция в отсортированном массиве, где элемент не меньше key. На каждом шаге выбирается
+    // одна из половин без условного перехода (cmov), и цикл делает ровно ceil(log2 n) итераций
+    // независимо от данных, так что процессору нечего ошибочно предсказывать
+    template <typename K, typename Compare>
+    size_t BranchlessLowerBound(const K* keys, size_t n, const K& key, const Compare& comp) {
+        if (n == 0) {
+            return 0;
+        }
+        const K* base = keys;
+        while (n > 1) {
+            const size_t half = n / 2;
+            base = comp(base[half], key) ? base + half : base;
+            n -= half;
+        }
+        return static_cast<size_t>(base - keys) + static_cast<size_t>(comp(*base, key));
+    }
+
+    template <typename K, typename Compare>
+    class SortedIndex {
+    public:
+        void Rebuild(const K* /*sorted*/, size_t /*n*/) noexcept {
+        }
+
+        size_t LowerBound(const K* sorted, size_t n, const K& key, const Compare& comp) const {
+            return BranchlessLowerBound(sorted, n, key, comp);
+        }
+    };
+
+    // Узел k (с единицы) имеет потомков 2k и 2k + 1. Для каждого узла хранится позиция его ключа
+    // в отсортированном массиве
+    template <typename K, typename Compare>
+    class EytzingerIndex {
+    public:
+        // Если построить индекс не удалось (нехватка памяти, исключение при копировании ключа),
+        // поиск идёт по отсортированному массиву до следующей успешной перестройки
+        void Rebuild(const K* sorted, size_t n) noexcept {
+            try {
+                Vector<size_t> ranks(n);
+                FillRanks(ranks, 0, 1);
+                Vector<K> tree;
+                tree.Reserve(n);
+                for (size_t rank : ranks) {
+                    tree.PushBack(sorted[rank]);
+                }
+                tree_.Swap(tree);
+                ranks_.Swap(ranks);
+                valid_ = true;
+            }
+            catch (...) {
+                tree_.Clear();
+                ranks_.Clear();
+                valid_ = false;
+            }
+        }
+
+        size_t LowerBound(const K* sorted, size_t n, const K& key, const Compare& comp) const {
+            if (!valid_) {
+                return BranchlessLowerBound(sorted, n, key, comp);
+            }
+            assert(tree_.Size() == n);
+            size_t k = 1;
+            while (k <= n) {
+                k = 2 * k + static_cast<size_t>(comp(tree_[k - 1], key));
+            }
+            // Последний поворот налево в пути - узел с искомым ключом: отбрасываем повороты направо после него
+            while ((k & 1) != 0) {
+                k >>= 1;
+            }
+            k >>= 1;
+            return k == 0 ? n : ranks_[k - 1];
+        }
+
+    private:
+        Vector<K> tree_;
+        Vector<size_t> ranks_;
+        bool valid_ = true;
+
+        // Симметричный обход дерева выдаёт позиции отсортированного массива по возрастанию
+        static size_t FillRanks(Vector<size_t>& ranks, size_t rank, size_t k) noexcept {
+            if (k <= ranks.Size()) {
+                rank = FillRanks(ranks, rank, 2 * k);
+                ranks[k - 1] = rank++;
+                rank = FillRanks(ranks, rank, 2 * k + 1);
+            }
+            return rank;
+        }
+    };
+
+    template <typename K, typename Compare, FlatLayout Layout>
+    using IndexFor = std::conditional_t<Layout == FlatLayout::EYTZINGER, EytzingerIndex<K, Compare>,
+                                        SortedIndex<K, Compare>>;
+
+    // Сливает за один проход отсортированные массивы без повторов keys и incoming.
+    // Для каждого элемента результата по порядку вызывает emit(from_incoming, index).
+    // Из равных ключей в результат попадает ключ из keys
+    template <typename K, typename Compare, typename Emit>
+    void MergeUnique(const Vector<K>& keys, const Vector<K>& incoming, const Compare& comp, Emit emit) {
+        size_t i = 0;
+        size_t j = 0;
+        while (i < keys.Size() && j < incoming.Size()) {
+            if (comp(incoming[j], keys[i])) {
+                emit(true, j++);
+            }
+            else {
+                if (!comp(keys[i], incoming[j])) {
+                    ++j;
+                }
+                emit(false, i++);
+            }
+        }
+        for (; i < keys.Size(); ++i) {
+            emit(false, i);
+        }
+        for (; j < incoming.Size(); ++j) {
+            emit(true, j);
+        }
+    }
+
+    // Элемент существующего массива для переноса в новый: перемещение, если оно не бросает
+    // исключений, иначе копия - тогда исключение оставляет контейнер прежним
+    template <typename T>
+    auto&& TakeExisting(T& value) noexcept {
+        return std::move_if_noexcept(value);
+    }
+
+}  // namespace flat_detail
+
+// Ассоциативный массив на двух отсортированных векторах: ключей и значений. Поиск читает только
+// плотный массив ключей, без обхода указателей, как в std::map. Вставка и удаление сдвигают хвост
+// за O(n), поэтому большие наборы лучше добавлять пакетом через InsertSorted.
+// Итератор - прокси: operator* возвращает пару ссылок (ключ, значение) по значению
+template <typename K, typename V, typename Compare = std::less<K>, FlatLayout Layout = FlatLayout::SORTED>
+class FlatMap {
+    template <bool IsConst>
+    class BasicIterator;
+
+public:
+    using key_type = K;
+    using mapped_type = V;
+    using key_compare = Compare;
+    using iterator = BasicIterator<false>;
+    using const_iterator = BasicIterator<true>;
+
+    FlatMap() = default;
+
+    explicit FlatMap(const Compare& comp)
+        : comp_(comp) {
+    }
+
+    // Элементы диапазона не обязаны быть упорядочены. Из элементов с равными ключами остаётся первый
+    template <typename It, typename = std::enable_if_t<IsIterator<It>::value>>
+    FlatMap(It first, It last, const Compare& comp = Compare())
+        : comp_(comp) {
+        Vector<std::pair<K, V>> items;
+        for (; first != last; ++first) {
+            items.EmplaceBack(*first);
+        }
+        std::stable_sort(items.begin(), items.end(), [this](const auto& lhs, const auto& rhs) {
+            return comp_(lhs.first, rhs.first);
+        });
+        InsertSorted(std::make_move_iterator(items.begin()), std::make_move_iterator(items.end()));
+    }
+
+    FlatMap(std::initializer_list<std::pair<K, V>> init, const Compare& comp = Compare())
+        : FlatMap(init.begin(), init.end(), comp) {
+    }
+
+    iterator begin() noexcept {
+        return iterator(this, 0);
+    }
+    iterator end() noexcept {
+        return iterator(this, Size());
+    }
+    const_iterator begin() const noexcept {
+        return const_iterator(this, 0);
+    }
+    const_iterator end() const noexcept {
+        return const_iterator(this, Size());
+    }
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    size_t Size() const noexcept {
+        return keys_.Size();
+    }
+
+    void Reserve(size_t capacity) {
+        keys_.Reserve(capacity);
+        values_.Reserve(capacity);
+    }
+
+    void Clear() noexcept {
+        keys_.Clear();
+        values_.Clear();
+        index_.Rebuild(keys_.begin(), 0);
+    }
+
+    // Ключи по возрастанию и значения в том же порядке
+    VectorView<const K> Keys() const noexcept {
+        return keys_.View();
+    }
+    VectorView<V> Values() noexcept {
+        return values_.View();
+    }
+    VectorView<const V> Values() const noexcept {
+        return values_.View();
+    }
+
+    // Первый элемент с ключом не меньше key
+    iterator LowerBound(const K& key) {
+        return iterator(this, LowerBoundIndex(key));
+    }
+    const_iterator LowerBound(const K& key) const {
+        return const_iterator(this, LowerBoundIndex(key));
+    }
+
+    iterator Find(const K& key) {
+        return iterator(this, FindIndex(key));
+    }
+    const_iterator Find(const K& key) const {
+        return const_iterator(this, FindIndex(key));
+    }
+
+    bool Contains(const K& key) const {
+        return FindIndex(key) != Size();
+    }
+
+    V& At(const K& key) {
+        const size_t index = FindIndex(key);
+        if (index == Size()) {
+            throw std::out_of_range("FlatMap key not found");
+        }
+        return values_[index];
+    }
+    const V& At(const K& key) const {
+        return const_cast<FlatMap&>(*this).At(key);
+    }
+
+    // Значение по ключу. Отсутствующий ключ добавляется со значением по умолчанию
+    V& operator[](const K& key) {
+        return (*TryEmplace(key).first).second;
+    }
+
+    // Добавляет элемент со значением из args, если ключа ещё нет. Иначе ничего не меняет
+    template <typename... Args>
+    std::pair<iterator, bool> TryEmplace(const K& key, Args&&... args) {
+        return EmplaceUnique(key, std::forward<Args>(args)...);
+    }
+    template <typename... Args>
+    std::pair<iterator, bool> TryEmplace(K&& key, Args&&... args) {
+        return EmplaceUnique(std::move(key), std::forward<Args>(args)...);
+    }
+
+    // Добавляет элемент или присваивает новое значение существующему
+    template <typename M>
+    std::pair<iterator, bool> InsertOrAssign(const K& key, M&& value) {
+        const size_t index = FindIndex(key);
+        if (index != Size()) {
+            values_[index] = std::forward<M>(value);
+            return { iterator(this, index), false };
+        }
+        return EmplaceUnique(key, std::forward<M>(value));
+    }
+
+    size_t Erase(const K& key) {
+        const size_t index = FindIndex(key);
+        if (index == Size()) {
+            return 0;
+        }
+        Erase(begin() + static_cast<std::ptrdiff_t>(index));
+        return 1;
+    }
+
+    iterator Erase(const_iterator pos) {
+        const size_t index = pos - cbegin();
+        keys_.Erase(keys_.begin() + index);
+        values_.Erase(values_.begin() + index);
+        index_.Rebuild(keys_.begin(), keys_.Size());
+        return iterator(this, index);
+    }
+
+    // Добавляет пары (ключ, значение) из диапазона, упорядоченного по ключам, за один проход слияния.
+    // Существующие ключи сохраняют свои значения, из повторов внутри диапазона берётся первый.
+    // Если перемещения ключей и значений не бросают исключений, при ошибке контейнер не меняется
+    template <typename It>
+    void InsertSorted(It first, It last);
+
+    void Swap(FlatMap& other) noexcept {
+        keys_.Swap(other.keys_);
+        values_.Swap(other.values_);
+        std::swap(comp_, other.comp_);
+        std::swap(index_, other.index_);
+    }
+
+private:
+    Vector<K> keys_;
+    Vector<V> values_;
+    [[no_unique_address]] Compare comp_;
+    flat_detail::IndexFor<K, Compare, Layout> index_;
+
+    size_t LowerBoundIndex(const K& key) const {
+        return index_.LowerBound(keys_.begin(), keys_.Size(), key, comp_);
+    }
+
+    size_t FindIndex(const K& key) const {
+        const size_t index = LowerBoundIndex(key);
+        return index < Size() && !comp_(key, keys_[index]) ? index : Size();
+    }
+
+    // Вставка идёт через Vector::Emplace в обе колонки. Если значение не удалось создать,
+    // уже вставленный ключ удаляется
+    template <typename Key, typename... Args>
+    std::pair<iterator, bool> EmplaceUnique(Key&& key, Args&&... args) {
+        const size_t index = LowerBoundIndex(key);
+        if (index < Size() && !comp_(key, keys_[index])) {
+            return { iterator(this, index), false };
+        }
+        keys_.Emplace(keys_.begin() + index, std::forward<Key>(key));
+        try {
+            values_.Emplace(values_.begin() + index, std::forward<Args>(args)...);
+        }
+        catch (...) {
+            keys_.Erase(keys_.begin() + index);
+            throw;
+        }
+        index_.Rebuild(keys_.begin(), keys_.Size());
+        return { iterator(this, index), true };
+    }
+};
+
+template <typename K, typename V, typename Compare, FlatLayout Layout>
+template <typename It>
+void FlatMap<K, V, Compare, Layout>::InsertSorted(It first, It last) {
+    // Новые элементы собираются отдельно, чтобы исключение при их копировании не затронуло контейнер
+    Vector<K> new_keys;
+    Vector<V> new_values;
+    if constexpr (std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<It>::iterator_category>) {
+        const size_t count = static_cast<size_t>(std::distance(first, last));
+        new_keys.Reserve(count);
+        new_values.Reserve(count);
+    }
+    for (; first != last; ++first) {
+        auto&& item = *first;
+        const K& key = std::get<0>(item);
+        if (new_keys.Size() != 0) {
+            assert(!comp_(key, new_keys[new_keys.Size() - 1]) && "InsertSorted requires a range sorted by key");
+            if (!comp_(new_keys[new_keys.Size() - 1], key)) {
+                continue;
+            }
+        }
+        new_keys.EmplaceBack(std::get<0>(std::forward<decltype(item)>(item)));
+        new_values.EmplaceBack(std::get<1>(std::forward<decltype(item)>(item)));
+    }
+    if (new_keys.Size() == 0) {
+        return;
+    }
+
+    Vector<K> merged_keys;
+    Vector<V> merged_values;
+    merged_keys.Reserve(keys_.Size() + new_keys.Size());
+    merged_values.Reserve(keys_.Size() + new_keys.Size());
+    flat_detail::MergeUnique(keys_, new_keys, comp_, [&](bool from_new, size_t i) {
+        if (from_new) {
+            merged_keys.EmplaceBack(std::move(new_keys[i]));
+            merged_values.EmplaceBack(std::move(new_values[i]));
+        }
+        else {
+            merged_keys.EmplaceBack(flat_detail::TakeExisting(keys_[i]));
+            merged_values.EmplaceBack(flat_detail::TakeExisting(values_[i]));
+        }
+    });
+    keys_.Swap(merged_keys);
+    values_.Swap(merged_values);
+    index_.Rebuild(keys_.begin(), keys_.Size());
+}
+
+// Итератор элементов FlatMap. Хранит номер элемента
+template <typename K, typename V, typename Compare, FlatLayout Layout>
+template <bool IsConst>
+class FlatMap<K, V, Compare, Layout>::BasicIterator {
+    using Container = std::conditional_t<IsConst, const FlatMap, FlatMap>;
+    using Value = std::conditional_t<IsConst, const V, V>;
+
+public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = std::pair<K, V>;
+    using difference_type = std::ptrdiff_t;
+    using reference = std::pair<const K&, Value&>;
+
+    // Позволяет писать it->first и it->second
+    struct pointer {
+        reference ref;
+
+        reference* operator->() noexcept {
+            return &ref;
+        }
+    };
+
+    BasicIterator() = default;
+
+    BasicIterator(Container* container, size_t index) noexcept
+        : container_(container)
+        , index_(index) {
+    }
+
+    // Неконстантный итератор неявно приводится к константному
+    template <bool OtherConst, typename = std::enable_if_t<IsConst && !OtherConst>>
+    BasicIterator(const BasicIterator<OtherConst>& other) noexcept
+        : container_(other.container_)
+        , index_(other.index_) {
+    }
+
+    reference operator*() const noexcept {
+        VECTOR_CHECK(index_ < container_->Size());
+        return reference(container_->keys_[index_], container_->values_[index_]);
+    }
+
+    pointer operator->() const noexcept {
+        return pointer{ **this };
+    }
+
+    BasicIterator& operator++() noexcept {
+        ++index_;
+        return *this;
+    }
+    BasicIterator operator++(int) noexcept {
+        BasicIterator old = *this;
+        ++index_;
+        return old;
+    }
+    BasicIterator& operator--() noexcept {
+        --index_;
+        return *this;
+    }
+    BasicIterator& operator+=(difference_type n) noexcept {
+        index_ += n;
+        return *this;
+    }
+    friend BasicIterator operator+(BasicIterator it, difference_type n) noexcept {
+        return it += n;
+    }
+    friend difference_type operator-(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+        return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+    }
+
+    friend bool operator==(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+        return lhs.index_ == rhs.index_;
+    }
+    friend bool operator!=(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+        return lhs.index_ != rhs.index_;
+    }
+
+private:
+    template <bool>
+    friend class BasicIterator;
+
+    Container* container_ = nullptr;
+    size_t index_ = 0;
+};
+
+// Множество на отсортированном векторе ключей. Итераторы - указатели на константные ключи
+template <typename K, typename Compare = std::less<K>, FlatLayout Layout = FlatLayout::SORTED>
+class FlatSet {
+public:
+    using key_type = K;
+    using key_compare = Compare;
+    using iterator = const K*;
+    using const_iterator = const K*;
+
+    FlatSet() = default;
+
+    explicit FlatSet(const Compare& comp)
+        : comp_(comp) {
+    }
+
+    // Элементы диапазона не обязаны быть упорядочены
+    template <typename It, typename = std::enable_if_t<IsIterator<It>::value>>
+    FlatSet(It first, It last, const Compare& comp = Compare())
+        : comp_(comp) {
+        Vector<K> keys(first, last);
+        std::sort(keys.begin(), keys.end(), comp_);
+        InsertSorted(std::make_move_iterator(keys.begin()), std::make_move_iterator(keys.end()));
+    }
+
+    FlatSet(std::initializer_list<K> init, const Compare& comp = Compare())
+        : FlatSet(init.begin(), init.end(), comp) {
+    }
+
+    const_iterator begin() const noexcept {
+        return keys_.begin();
+    }
+    const_iterator end() const noexcept {
+        return keys_.end();
+    }
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    size_t Size() const noexcept {
+        return keys_.Size();
+    }
+
+    void Reserve(size_t capacity) {
+        keys_.Reserve(capacity);
+    }
+
+    void Clear() noexcept {
+        keys_.Clear();
+        index_.Rebuild(keys_.begin(), 0);
+    }
+
+    VectorView<const K> View() const noexcept {
+        return keys_.View();
+    }
+
+    const_iterator LowerBound(const K& key) const {
+        return begin() + LowerBoundIndex(key);
+    }
+
+    const_iterator Find(const K& key) const {
+        const size_t index = LowerBoundIndex(key);
+        return index < Size() && !comp_(key, keys_[index]) ? begin() + index : end();
+    }
+
+    bool Contains(const K& key) const {
+        return Find(key) != end();
+    }
+
+    std::pair<const_iterator, bool> Insert(const K& key) {
+        return InsertUnique(key);
+    }
+    std::pair<const_iterator, bool> Insert(K&& key) {
+        return InsertUnique(std::move(key));
+    }
+
+    template <typename... Args>
+    std::pair<const_iterator, bool> Emplace(Args&&... args) {
+        return InsertUnique(K(std::forward<Args>(args)...));
+    }
+
+    size_t Erase(const K& key) {
+        const_iterator pos = Find(key);
+        if (pos == end()) {
+            return 0;
+        }
+        Erase(pos);
+        return 1;
+    }
+
+    const_iterator Erase(const_iterator pos) {
+        const size_t index = pos - begin();
+        keys_.Erase(keys_.begin() + index);
+        index_.Rebuild(keys_.begin(), keys_.Size());
+        return begin() + index;
+    }
+
+    // Добавляет ключи из упорядоченного диапазона за один проход слияния, повторы пропускаются.
+    // Если перемещение ключей не бросает исключений, при ошибке множество не меняется
+    template <typename It>
+    void InsertSorted(It first, It last);
+
+    void Swap(FlatSet& other) noexcept {
+        keys_.Swap(other.keys_);
+        std::swap(comp_, other.comp_);
+        std::swap(index_, other.index_);
+    }
+
+private:
+    Vector<K> keys_;
+    [[no_unique_address]] Compare comp_;
+    flat_detail::IndexFor<K, Compare, Layout> index_;
+
+    size_t LowerBoundIndex(const K& key) const {
+        return index_.LowerBound(keys_.begin(), keys_.Size(), key, comp_);
+    }
+
+    template <typename Key>
+    std::pair<const_iterator, bool> InsertUnique(Key&& key) {
+        const size_t index = LowerBoundIndex(key);
+        if (index < Size() && !comp_(key, keys_[index])) {
+            return { begin() + index, false };
+        }
+        keys_.Emplace(keys_.begin() + index, std::forward<Key>(key));
+        index_.Rebuild(keys_.begin(), keys_.Size());
+        return { begin() + index, true };
+    }
+};
+
+template <typename K, typename Compare, FlatLayout Layout>
+template <typename It>
+void FlatSet<K, Compare, Layout>::InsertSorted(It first, It last) {
+    Vector<K> new_keys;
+    if constexpr (std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<It>::iterator_category>) {
+        new_keys.Reserve(static_cast<size_t>(std::distance(first, last)));
+    }
+    for (; first != last; ++first) {
+        auto&& key = *first;
+        if (new_keys.Size() != 0) {
+            assert(!comp_(key, new_keys[new_keys.Size() - 1]) && "InsertSorted requires a sorted range");
+            if (!comp_(new_keys[new_keys.Size() - 1], key)) {
+                continue;
+            }
+        }
+        new_keys.EmplaceBack(std::forward<decltype(key)>(key));
+    }
+    if (new_keys.Size() == 0) {
+        return;
+    }
+
+    Vector<K> merged;
+    merged.Reserve(keys_.Size() + new_keys.Size());
+    flat_detail::MergeUnique(keys_, new_keys, comp_, [&](bool from_new, size_t i) {
+        if (from_new) {
+            merged.EmplaceBack(std::move(new_keys[i]));
+        }
+        else {
+            merged.EmplaceBack(flat_detail::TakeExisting(keys_[i]));
+        }
+    });
+    keys_.Swap(merged);
+    index_.Rebuild(keys_.begin(), keys_.Size());
+}
@@ -0,0 +1,271 @@
+#pragma once
+
+#include "vector.h"
+
+#include <cerrno>
+#include <cstdint>
+
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Размещение больших буферов Vector на больших страницах и на выбранных узлах NUMA (Linux).
+// Буфер от min_bytes байт - отдельное анонимное отображение, выровненное по 2 МиБ, меньшие
+// буферы выделяются обычным operator new. Страницы выделяются ядром при первом обращении:
+// Prefault позволяет сделать это заранее, вне критичного по задержке пути
+
+enum class HugePages {
+    // Прозрачные большие страницы (MADV_HUGEPAGE). Ядро собирает их по возможности, без резерва
+    TRANSPARENT,
+    // Страницы hugetlbfs по 2 МиБ и 1 ГиБ - из резерва, настроенного в vm.nr_hugepages
+    EXPLICIT_2M,
+    EXPLICIT_1G,
+};
+
+enum class NumaPolicy {
+    // Политика потока: обычно узел потока, впервые коснувшегося страницы
+    DEFAULT,
+    // Только узлы из маски
+    BIND,
+    // Страницы по очереди на узлах маски - равномерная пропускная способность для всех потоков
+    INTERLEAVE,
+    // Узел из маски, пока на нём есть память
+    PREFERRED,
+};
+
+struct HugePageOptions {
+    HugePages pages = HugePages::TRANSPARENT;
+    // Если резерв hugetlbfs исчерпан, использовать прозрачные большие страницы вместо std::bad_alloc
+    bool fallback = true;
+
+    NumaPolicy numa = NumaPolicy::DEFAULT;
+    // Битовая маска узлов (бит i - узел i). Для INTERLEAVE пустая маска означает все доступные узлы
+    unsigned long nodes = 0;
+
+    // Буферы меньшего размера не отображаются отдельно
+    size_t min_bytes = HUGE_PAGE_ALIGNMENT;
+    // Выделять страницы сразу при выделении буфера
+    bool prefault = false;
+
+    static HugePageOptions OnNode(int node) noexcept {
+        HugePageOptions options;
+        options.numa = NumaPolicy::BIND;
+        options.nodes = 1UL << node;
+        return options;
+    }
+
+    static HugePageOptions Interleaved() noexcept {
+        HugePageOptions options;
+        options.numa = NumaPolicy::INTERLEAVE;
+        return options;
+    }
+
+    bool operator==(const HugePageOptions& other) const noexcept {
+        return pages == other.pages && fallback == other.fallback && numa == other.numa && nodes == other.nodes
+               && min_bytes == other.min_bytes && prefault == other.prefault;
+    }
+    bool operator!=(const HugePageOptions& other) const noexcept {
+        return !(*this == other);
+    }
+};
+
+namespace huge_page_detail {
+
+    inline constexpr size_t SMALL_PAGE = 4096;
+    inline constexpr unsigned long MAX_NODES = sizeof(unsigned long) * 8;
+
+    inline size_t PageBytes(HugePages pages) noexcept {
+        return pages == HugePages::EXPLICIT_1G ? size_t{ 1 } << 30 : HUGE_PAGE_ALIGNMENT;
+    }
+
+    inline size_t RoundUp(size_t bytes, size_t page) noexcept {
+        return (bytes + page - 1) & ~(page - 1);
+    }
+
+    // Узлы, на которых потоку разрешено выделять память, или 0, если это не удалось узнать
+    inline unsigned long AllowedNodes() noexcept {
+        unsigned long mask = 0;
+        if (::syscall(SYS_get_mempolicy, nullptr, &mask, MAX_NODES + 1, nullptr, MPOL_F_MEMS_ALLOWED) != 0) {
+            return 0;
+        }
+        return mask;
+    }
+
+    // Привязка к узлам - пожелание: в контейнерах без CAP_SYS_NICE и на машинах без NUMA
+    // mbind может быть недоступен, и тогда буфер остаётся с политикой по умолчанию
+    inline void Bind(void* p, size_t bytes, const HugePageOptions& options) noexcept {
+        if (options.numa == NumaPolicy::DEFAULT) {
+            return;
+        }
+        unsigned long mask = options.nodes;
+        if (mask == 0 && options.numa == NumaPolicy::INTERLEAVE) {
+            mask = AllowedNodes();
+        }
+        if (mask == 0) {
+            return;
+        }
+        const int mode = options.numa == NumaPolicy::BIND         ? MPOL_BIND
+                         : options.numa == NumaPolicy::INTERLEAVE ? MPOL_INTERLEAVE
+                                                                  : MPOL_PREFERRED;
+        ::syscall(SYS_mbind, p, bytes, mode, &mask, MAX_NODES + 1, 0);
+    }
+
+    // Отображение bytes байт, начало которого выровнено по align: лишнее по краям снимается
+    inline void* MapAligned(size_t bytes, size_t align) noexcept {
+        void* raw = ::mmap(nullptr, bytes + align, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) {
+            return nullptr;
+        }
+        const uintptr_t begin = reinterpret_cast<uintptr_t>(raw);
+        const uintptr_t aligned = (begin + align - 1) & ~(uintptr_t{ align } - 1);
+        if (aligned != begin) {
+            ::munmap(raw, aligned - begin);
+        }
+        if (const size_t tail = align - (aligned - begin); tail != 0) {
+            ::munmap(reinterpret_cast<void*>(aligned + bytes), tail);
+        }
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    inline void* MapExplicit(size_t bytes, HugePages pages) noexcept {
+        const int size_flag = (pages == HugePages::EXPLICIT_1G ? 30 : 21) << MAP_HUGE_SHIFT;
+        void* p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | size_flag,
+                         -1, 0);
+        return p == MAP_FAILED ? nullptr : p;
+    }
+
+}  // namespace huge_page_detail
+
+// Выделяет физические страницы участка без изменения его содержимого. Если ядро не поддерживает
+// MADV_POPULATE_WRITE (до Linux 5.14), в каждую страницу записывается её же байт, поэтому
+// одновременная запись в участок из других потоков недопустима
+inline void PrefaultMemory(void* p, size_t bytes) noexcept {
+    if (p == nullptr || bytes == 0) {
+        return;
+    }
+    const uintptr_t begin = reinterpret_cast<uintptr_t>(p) & ~(huge_page_detail::SMALL_PAGE - 1);
+    const uintptr_t end = reinterpret_cast<uintptr_t>(p) + bytes;
+#ifdef MADV_POPULATE_WRITE
+    if (::madvise(reinterpret_cast<void*>(begin), end - begin, MADV_POPULATE_WRITE) == 0) {
+        return;
+    }
+#endif
+    volatile char* first = static_cast<volatile char*>(p);
+    *first = *first;
+    for (uintptr_t page = begin + huge_page_detail::SMALL_PAGE; page < end; page += huge_page_detail::SMALL_PAGE) {
+        volatile char* byte = reinterpret_cast<volatile char*>(page);
+        *byte = *byte;
+    }
+}
+
+// Выделяет страницы всего буфера вектора, включая запас вместимости
+template <typename T, typename Alloc, typename Growth>
+void Prefault(Vector<T, Alloc, Growth>& vector) noexcept {
+    PrefaultMemory(vector.View().Data(), vector.Capacity() * sizeof(T));
+}
+
+// Узел NUMA, на котором лежит страница с адресом p, или -1, если страница ещё не выделена
+// или ядро не сообщает узел
+inline int NumaNodeOf(const void* p) noexcept {
+    int node = -1;
+    if (::syscall(SYS_get_mempolicy, &node, nullptr, 0, p, MPOL_F_NODE | MPOL_F_ADDR) != 0) {
+        return -1;
+    }
+    return node;
+}
+
+// Аллокатор для больших векторов. Отображение округляется до большой страницы, и рост в пределах
+// округления идёт на месте через try_expand
+template <typename T>
+class HugePageAllocator {
+    static_assert(alignof(T) <= alignof(std::max_align_t), "small buffers come from operator new");
+
+public:
+    using value_type = T;
+
+    HugePageAllocator() noexcept = default;
+
+    explicit HugePageAllocator(const HugePageOptions& options) noexcept
+        : options_(options) {
+    }
+
+    template <typename U>
+    HugePageAllocator(const HugePageAllocator<U>& other) noexcept
+        : options_(other.GetOptions()) {
+    }
+
+    const HugePageOptions& GetOptions() const noexcept {
+        return options_;
+    }
+
+    T* allocate(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T) - HUGE_PAGE_ALIGNMENT) {
+            throw std::bad_array_new_length();
+        }
+        const size_t bytes = n * sizeof(T);
+        if (bytes < options_.min_bytes) {
+            return static_cast<T*>(::operator new(bytes));
+        }
+        const size_t length = MappedBytes(bytes);
+        void* p = nullptr;
+        if (options_.pages != HugePages::TRANSPARENT) {
+            p = huge_page_detail::MapExplicit(length, options_.pages);
+            if (p == nullptr && !options_.fallback) {
+                throw std::bad_alloc();
+            }
+        }
+        if (p == nullptr) {
+            p = huge_page_detail::MapAligned(length, HUGE_PAGE_ALIGNMENT);
+            if (p == nullptr) {
+                throw std::bad_alloc();
+            }
+            ::madvise(p, length, MADV_HUGEPAGE);
+        }
+        // Политика NUMA должна быть назначена до первого обращения к страницам
+        huge_page_detail::Bind(p, length, options_);
+        if (options_.prefault) {
+            PrefaultMemory(p, length);
+        }
+        return static_cast<T*>(p);
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        const size_t bytes = n * sizeof(T);
+        if (bytes < options_.min_bytes) {
+            ::operator delete(p);
+        }
+        else {
+            ::munmap(p, MappedBytes(bytes));
+        }
+    }
+
+    bool try_expand(T* /*p*/, size_t old_n, size_t new_n) noexcept {
+        const size_t old_bytes = old_n * sizeof(T);
+        if (old_bytes < options_.min_bytes || new_n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            return false;
+        }
+        return new_n * sizeof(T) <= MappedBytes(old_bytes);
+    }
+
+    template <typename U>
+    bool operator==(const HugePageAllocator<U>& other) const noexcept {
+        return options_ == other.GetOptions();
+    }
+    template <typename U>
+    bool operator!=(const HugePageAllocator<U>& other) const noexcept {
+        return !(*this == other);
+    }
+
+private:
+    HugePageOptions options_;
+
+    // Длина отображения не зависит от того, удалось ли получить страницы hugetlbfs, поэтому
+    // deallocate вычисляет её так же, как allocate
+    size_t MappedBytes(size_t bytes) const noexcept {
+        return huge_page_detail::RoundUp(bytes, huge_page_detail::PageBytes(options_.pages));
+    }
+};
+
+template <typename T, typename Growth = DoublingGrowth>
+using HugePageVector = Vector<T, HugePageAllocator<T>, Growth>;
@@ -1,10 +1,39 @@
 #include "vector.h"
+#include "small_vector.h"
+#include "segmented_vector.h"
+#include "concurrent_vector.h"
+#include "mapped_vector.h"
+#include "vector_io.h"
+#include "vector_algorithms.h"
+#include "soa_vector.h"
+#include "arena.h"
+#include "buffer_pool.h"
+#include "static_vector.h"
+#include "flat_map.h"
+#include "shared_vector.h"
+#include "huge_page_allocator.h"
 
+#include <array>
+#include <cmath>
+#include <cstdint>
 #include <iostream>
+#include <iterator>
+#include <list>
+#include <map>
+#include <numeric>
+#include <random>
+#include <set>
+#include <sstream>
 #include <stdexcept>
+#include <atomic>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
 namespace {
 
     // "Магическое" число, используемое для отслеживания живости объекта
@@ -437,7 +466,7 @@ void Test6() {
     {
         Obj::ResetCounters();
         Vector<Obj> v;
-        auto* pos = v.Emplace(v.end(), Obj{ 1 });
+        auto pos = v.Emplace(v.end(), Obj{ 1 });
         assert(v.Size() == 1);
         assert(v.Capacity() >= v.Size());
         assert(&*pos == &v[0]);
@@ -452,7 +481,7 @@ void Test6() {
         Obj::ResetCounters();
         Vector<Obj> v;
         v.Reserve(SIZE);
-        auto* pos = v.Emplace(v.end(), Obj{ 1 });
+        auto pos = v.Emplace(v.end(), Obj{ 1 });
         assert(v.Size() == 1);
         assert(v.Capacity() >= v.Size());
         assert(&*pos == &v[0]);
@@ -499,7 +528,7 @@ void Test6() {
     {
         Obj::ResetCounters();
         Vector<Obj> v{SIZE};
-        auto* pos = v.Emplace(v.cbegin() + 1, ID, "Ivan"s);
+        auto pos = v.Emplace(v.cbegin() + 1, ID, "Ivan"s);
         assert(v.Size() == SIZE + 1);
         assert(v.Capacity() == SIZE * 2);
         assert(&*pos == &v[1]);
@@ -515,7 +544,7 @@ void Test6() {
     {
         Obj::ResetCounters();
         Vector<Obj> v{SIZE};
-        auto* pos = v.Emplace(v.cbegin() + v.Size(), ID, "Ivan"s);
+        auto pos = v.Emplace(v.cbegin() + v.Size(), ID, "Ivan"s);
         assert(v.Size() == SIZE + 1);
         assert(v.Capacity() == SIZE * 2);
         assert(&*pos == &v[SIZE]);
@@ -534,7 +563,7 @@ void Test6() {
         v.Reserve(SIZE * 2);
         const int old_num_moved = Obj::num_moved;
         assert(v.Capacity() == SIZE * 2);
-        auto* pos = v.Emplace(v.cbegin() + 3, ID, "Ivan"s);
+        auto pos = v.Emplace(v.cbegin() + 3, ID, "Ivan"s);
         assert(v.Size() == SIZE + 1);
         assert(&*pos == &v[3]);
         assert(v[3].id == ID);
@@ -550,7 +579,7 @@ void Test6() {
         Obj::ResetCounters();
         Vector<Obj> v{SIZE};
         v[2].id = ID;
-        auto* pos = v.Erase(v.cbegin() + 1);
+        auto pos = v.Erase(v.cbegin() + 1);
         assert((pos - v.begin()) == 1);
         assert(v.Size() == SIZE - 1);
         assert(v.Capacity() == SIZE);
@@ -563,87 +592,2471 @@ void Test6() {
     }
 }
 
-struct C {
-    C() noexcept {
-        ++def_ctor;
+// Аллокатор с состоянием: ведёт учёт выделенных байт в общем для копий счётчике
+template <typename T, bool Propagate>
+struct TrackingAllocator {
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::bool_constant<Propagate>;
+    using propagate_on_container_move_assignment = std::bool_constant<Propagate>;
+    using propagate_on_container_swap = std::bool_constant<Propagate>;
+
+    struct Stats {
+        int id = 0;
+        size_t allocations = 0;
+        size_t bytes_in_use = 0;
+    };
+
+    explicit TrackingAllocator(Stats& stats) noexcept
+        : stats(&stats) {
+    }
+
+    template <typename U>
+    TrackingAllocator(const TrackingAllocator<U, Propagate>& other) noexcept
+        : stats(other.stats) {
+    }
+
+    T* allocate(size_t n) {
+        ++stats->allocations;
+        stats->bytes_in_use += n * sizeof(T);
+        return static_cast<T*>(operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        stats->bytes_in_use -= n * sizeof(T);
+        operator delete(p);
+    }
+
+    template <typename U>
+    bool operator==(const TrackingAllocator<U, Propagate>& other) const noexcept {
+        return stats == other.stats;
+    }
+    template <typename U>
+    bool operator!=(const TrackingAllocator<U, Propagate>& other) const noexcept {
+        return stats != other.stats;
+    }
+
+    Stats* stats;
+};
+
+// Аллокатор, выбрасывающий bad_alloc на заданном по счёту выделении
+template <typename T>
+struct FailingAllocator {
+    using value_type = T;
+
+    FailingAllocator() = default;
+
+    template <typename U>
+    FailingAllocator(const FailingAllocator<U>&) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        if (fail_countdown > 0 && --fail_countdown == 0) {
+            throw std::bad_alloc();
+        }
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template <typename U>
+    bool operator==(const FailingAllocator<U>&) const noexcept {
+        return true;
+    }
+    template <typename U>
+    bool operator!=(const FailingAllocator<U>&) const noexcept {
+        return false;
+    }
+
+    static inline int fail_countdown = 0;
+};
+
+void Test7() {
+    const size_t SIZE = 100;
+    const int ID = 42;
+    {
+        using Alloc = TrackingAllocator<Obj, false>;
+        Alloc::Stats stats;
+        Obj::ResetCounters();
+        {
+            Vector<Obj, Alloc> v{ Alloc(stats) };
+            for (size_t i = 0; i < SIZE; ++i) {
+                v.EmplaceBack(ID);
+            }
+            assert(stats.allocations > 0);
+            assert(stats.bytes_in_use == v.Capacity() * sizeof(Obj));
+
+            const Vector<Obj, Alloc> v_copy(v);
+            assert(v_copy.GetAllocator() == v.GetAllocator());
+            assert(stats.bytes_in_use == (v.Capacity() + v_copy.Capacity()) * sizeof(Obj));
+        }
+        assert(stats.bytes_in_use == 0);
+        assert(Obj::GetAliveObjectCount() == 0);
     }
-    C(const C& /*other*/) noexcept {
-        ++copy_ctor;
+    {
+        // Без propagate_on_container_move_assignment неравные аллокаторы не обмениваются буферами
+        using Alloc = TrackingAllocator<Obj, false>;
+        Alloc::Stats lhs_stats;
+        Alloc::Stats rhs_stats;
+        Obj::ResetCounters();
+        {
+            Vector<Obj, Alloc> lhs(SIZE / 2, Alloc(lhs_stats));
+            Vector<Obj, Alloc> rhs(SIZE, Alloc(rhs_stats));
+            rhs[SIZE - 1].id = ID;
+            lhs = std::move(rhs);
+            assert(lhs.Size() == SIZE);
+            assert(lhs[SIZE - 1].id == ID);
+            assert(lhs.GetAllocator().stats == &lhs_stats);
+            assert(Obj::num_moved == static_cast<int>(SIZE));
+            assert(lhs_stats.bytes_in_use == SIZE * sizeof(Obj));
+        }
+        assert(lhs_stats.bytes_in_use == 0);
+        assert(rhs_stats.bytes_in_use == 0);
+        assert(Obj::GetAliveObjectCount() == 0);
     }
-    C(C&& /*other*/) noexcept {
-        ++move_ctor;
+    {
+        // Без propagate_on_container_copy_assignment копия при нехватке ёмкости
+        // строится на аллокаторе lhs
+        using Alloc = TrackingAllocator<Obj, false>;
+        Alloc::Stats lhs_stats;
+        Alloc::Stats rhs_stats;
+        Obj::ResetCounters();
+        {
+            Vector<Obj, Alloc> lhs(SIZE / 2, Alloc(lhs_stats));
+            Vector<Obj, Alloc> rhs(SIZE, Alloc(rhs_stats));
+            rhs[SIZE - 1].id = ID;
+            lhs = rhs;
+            assert(lhs.Size() == SIZE);
+            assert(lhs[SIZE - 1].id == ID);
+            assert(lhs.GetAllocator().stats == &lhs_stats);
+            assert(rhs.GetAllocator().stats == &rhs_stats);
+            assert(lhs_stats.bytes_in_use == lhs.Capacity() * sizeof(Obj));
+            assert(rhs_stats.bytes_in_use == rhs.Capacity() * sizeof(Obj));
+        }
+        assert(lhs_stats.bytes_in_use == 0);
+        assert(rhs_stats.bytes_in_use == 0);
+        assert(Obj::GetAliveObjectCount() == 0);
     }
-    C& operator=(const C& other) noexcept {
-        if (this != &other) {
-            ++copy_assign;
+    {
+        using Alloc = TrackingAllocator<Obj, true>;
+        Alloc::Stats lhs_stats;
+        Alloc::Stats rhs_stats;
+        Obj::ResetCounters();
+        {
+            Vector<Obj, Alloc> lhs(SIZE / 2, Alloc(lhs_stats));
+            Vector<Obj, Alloc> rhs(SIZE, Alloc(rhs_stats));
+            lhs.Swap(rhs);
+            assert(lhs.Size() == SIZE);
+            assert(lhs.GetAllocator().stats == &rhs_stats);
+            assert(rhs.GetAllocator().stats == &lhs_stats);
+
+            lhs = std::move(rhs);
+            assert(lhs.Size() == SIZE / 2);
+            assert(lhs.GetAllocator().stats == &lhs_stats);
+            assert(rhs_stats.bytes_in_use == 0);
+            assert(Obj::num_moved == 0);
+
+            Vector<Obj, Alloc> other(SIZE, Alloc(rhs_stats));
+            lhs = other;
+            assert(lhs.Size() == SIZE);
+            assert(lhs.GetAllocator().stats == &rhs_stats);
+            assert(lhs_stats.bytes_in_use == 0);
         }
-        return *this;
+        assert(rhs_stats.bytes_in_use == 0);
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+}
+
+// Тип с нетривиальными операциями, для которого перенос в памяти явно разрешён
+struct RelocatableObj {
+    RelocatableObj() = default;
+    explicit RelocatableObj(int id)
+        : id(id) {
     }
-    C& operator=(C&& /*other*/) noexcept {
-        ++move_assign;
-        return *this;
+    RelocatableObj(const RelocatableObj& other)
+        : id(other.id) {
+        ++num_copied;
     }
-    ~C() {
-        ++dtor;
+    RelocatableObj(RelocatableObj&& other) noexcept
+        : id(other.id) {
+        ++num_moved;
+    }
+    RelocatableObj& operator=(const RelocatableObj& other) = default;
+    RelocatableObj& operator=(RelocatableObj&& other) = default;
+    ~RelocatableObj() {
+        ++num_destroyed;
     }
 
-    static void Reset() {
-        def_ctor = 0;
-        copy_ctor = 0;
-        move_ctor = 0;
-        copy_assign = 0;
-        move_assign = 0;
-        dtor = 0;
+    static void ResetCounters() {
+        num_copied = 0;
+        num_moved = 0;
+        num_destroyed = 0;
     }
 
-    inline static size_t def_ctor = 0;
-    inline static size_t copy_ctor = 0;
-    inline static size_t move_ctor = 0;
-    inline static size_t copy_assign = 0;
-    inline static size_t move_assign = 0;
-    inline static size_t dtor = 0;
+    int id = 0;
+
+    static inline int num_copied = 0;
+    static inline int num_moved = 0;
+    static inline int num_destroyed = 0;
 };
 
-void Dump() {
-    using namespace std;
-    cerr << "Def ctors: "sv << C::def_ctor              //
-        << ", Copy ctors: "sv << C::copy_ctor          //
-        << ", Move ctors: "sv << C::move_ctor          //
-        << ", Copy assignments: "sv << C::copy_assign  //
-        << ", Move assignments: "sv << C::move_assign  //
-        << ", Dtors: "sv << C::dtor << endl;
+template <>
+struct IsTriviallyRelocatable<RelocatableObj> : std::true_type {};
+
+void Test8() {
+    const size_t SIZE = 1000;
+    static_assert(IsTriviallyRelocatableV<int>);
+    static_assert(IsTriviallyRelocatableV<std::unique_ptr<int>>);
+    static_assert(!IsTriviallyRelocatableV<std::string>);
+    static_assert(!IsTriviallyRelocatableV<Obj>);
+    {
+        RelocatableObj::ResetCounters();
+        Vector<RelocatableObj> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(static_cast<int>(i));
+        }
+        v.Reserve(SIZE * 4);
+        assert(RelocatableObj::num_moved == 0);
+        assert(RelocatableObj::num_copied == 0);
+        assert(RelocatableObj::num_destroyed == 0);
+        assert(v.Size() == SIZE);
+        assert(v.Capacity() == SIZE * 4);
+        for (size_t i = 0; i < SIZE; ++i) {
+            assert(v[i].id == static_cast<int>(i));
+        }
+    }
+    assert(RelocatableObj::num_destroyed == static_cast<int>(SIZE));
+    {
+        Vector<std::unique_ptr<int>> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(std::make_unique<int>(static_cast<int>(i)));
+        }
+        v.Emplace(v.begin(), std::make_unique<int>(-1));
+        assert(*v[0] == -1);
+        for (size_t i = 0; i < SIZE; ++i) {
+            assert(*v[i + 1] == static_cast<int>(i));
+        }
+    }
 }
 
-void Benchmark() {
-    using namespace std;
-    try {
-        const size_t NUM = 10;
-        C c;
+void Test9() {
+    const size_t SIZE = 100'000;
+    {
+        Vector<int, ReallocAllocator<int>> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(static_cast<int>(i));
+        }
+        assert(v.Size() == SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            assert(v[i] == static_cast<int>(i));
+        }
+        v.Reserve(SIZE * 8);
+        assert(v.Capacity() == SIZE * 8);
+        assert(v[SIZE - 1] == static_cast<int>(SIZE - 1));
+    }
+    {
+        // Аргумент, ссылающийся на элемент вектора, должен пережить перенос буфера
+        Vector<int, ReallocAllocator<int>> v(1);
+        v[0] = 42;
+        for (size_t i = 0; i < 20; ++i) {
+            v.PushBack(v[0]);
+            v.Emplace(v.begin() + v.Size() / 2, v[v.Size() - 1]);
+        }
+        assert(std::all_of(v.begin(), v.end(), [](int x) {
+            return x == 42;
+            }));
+    }
+    {
+        RelocatableObj::ResetCounters();
         {
-            cerr << "std::vector:"sv << endl;
-            C::Reset();
-            vector<C> v(NUM);
-            Dump();
-            v.push_back(c);
+            Vector<RelocatableObj, ReallocAllocator<RelocatableObj>> v;
+            for (size_t i = 0; i < SIZE; ++i) {
+                v.EmplaceBack(static_cast<int>(i));
+            }
+            assert(RelocatableObj::num_moved == 0);
+            assert(RelocatableObj::num_copied == 0);
+            assert(RelocatableObj::num_destroyed == 0);
+            for (size_t i = 0; i < SIZE; ++i) {
+                assert(v[i].id == static_cast<int>(i));
+            }
         }
-        Dump();
+        assert(RelocatableObj::num_destroyed == static_cast<int>(SIZE));
     }
-    catch (...) {
+}
+
+// Пользовательская политика: буфер растёт фиксированными порциями
+struct FixedStepGrowth {
+    static size_t NextCapacity(size_t capacity, size_t required, size_t /*elem_size*/) noexcept {
+        return std::max(capacity + 100, required);
     }
-    try {
-        const size_t NUM = 10;
-        C c;
+};
+
+void Test10() {
+    {
+        Vector<int, std::allocator<int>, OneAndHalfGrowth> v;
+        std::vector<size_t> capacities;
+        for (int i = 0; i < 20; ++i) {
+            v.PushBack(i);
+            if (capacities.empty() || capacities.back() != v.Capacity()) {
+                capacities.push_back(v.Capacity());
+            }
+        }
+        assert((capacities == std::vector<size_t>{ 1, 2, 3, 4, 6, 9, 13, 19, 28 }));
+    }
+    {
+        Vector<int, std::allocator<int>, CacheLineGrowth<>> v;
+        v.EmplaceBack(1);
+        assert(v.Capacity() == 64 / sizeof(int));
+        for (int i = 0; i < 16; ++i) {
+            v.PushBack(i);
+        }
+        assert(v.Capacity() == 2 * 64 / sizeof(int));
+    }
+    {
+        struct Record {
+            char data[12];
+        };
+        Vector<Record, std::allocator<Record>, PageGrowth<DoublingGrowth, 4096, 4096>> v;
+        for (int i = 0; i < 1000; ++i) {
+            v.PushBack(Record{});
+            if (v.Capacity() * sizeof(Record) >= 4096) {
+                assert(v.Capacity() == (v.Capacity() * sizeof(Record) + 4095) / 4096 * 4096 / sizeof(Record));
+            }
+        }
+        assert(v.Capacity() * sizeof(Record) > 4096 * 2);
+    }
+    {
+        Vector<int, std::allocator<int>, FixedStepGrowth> v;
+        v.Emplace(v.end(), 1);
+        assert(v.Capacity() == 100);
+        v.Resize(100);
+        v.Insert(v.begin(), 0);
+        assert(v.Capacity() == 200);
+        assert(v[0] == 0 && v[1] == 1);
+    }
+}
+
+void Test11() {
+    const size_t N = 8;
+    const int ID = 42;
+    using namespace std::literals;
+    using Alloc = TrackingAllocator<Obj, false>;
+    {
+        Alloc::Stats stats;
+        Obj::ResetCounters();
+        {
+            SmallVector<Obj, N, Alloc> v{ Alloc(stats) };
+            for (size_t i = 0; i < N; ++i) {
+                v.EmplaceBack(static_cast<int>(i));
+            }
+            assert(v.IsInline());
+            assert(v.Capacity() == N);
+            assert(stats.allocations == 0);
+
+            v.Insert(v.begin() + 1, Obj{ ID });
+            assert(!v.IsInline());
+            assert(v.Size() == N + 1);
+            assert(v.Capacity() == N * 2);
+            assert(stats.allocations == 1);
+            assert(v[0].id == 0 && v[1].id == ID && v[2].id == 1);
+
+            auto pos = v.Erase(v.begin());
+            assert(pos == v.begin());
+            assert(v[0].id == ID);
+            v.Resize(2);
+            assert(Obj::GetAliveObjectCount() == 2);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+        assert(stats.bytes_in_use == 0);
+    }
+    {
+        // Копия при нехватке ёмкости строится на аллокаторе lhs, а не rhs
+        Alloc::Stats lhs_stats;
+        Alloc::Stats rhs_stats;
+        Obj::ResetCounters();
         {
-            cerr << "Vector:"sv << endl;
-            C::Reset();
-            Vector<C> v(NUM);
-            Dump();
-            v.PushBack(c);
+            SmallVector<Obj, N, Alloc> lhs{ Alloc(lhs_stats) };
+            lhs.EmplaceBack(0);
+            SmallVector<Obj, N, Alloc> rhs(N * 2, Alloc(rhs_stats));
+            rhs[N].id = ID;
+            lhs = rhs;
+            assert(lhs.Size() == N * 2 && lhs[N].id == ID);
+            assert(lhs.GetAllocator().stats == &lhs_stats);
+            assert(lhs_stats.bytes_in_use == lhs.Capacity() * sizeof(Obj));
+            assert(rhs_stats.bytes_in_use == rhs.Capacity() * sizeof(Obj));
+        }
+        assert(lhs_stats.bytes_in_use == 0);
+        assert(rhs_stats.bytes_in_use == 0);
+        assert(Obj::GetAliveObjectCount() == 0);
+
+        using IntAlloc = TrackingAllocator<int, false>;
+        static_assert(std::is_nothrow_move_assignable_v<SmallVector<int, N>>);
+        static_assert(!std::is_nothrow_move_assignable_v<SmallVector<int, N, IntAlloc>>);
+        static_assert(!noexcept(std::declval<SmallVector<int, N, IntAlloc>&>().Swap(
+            std::declval<SmallVector<int, N, IntAlloc>&>())));
+    }
+    {
+        Obj::ResetCounters();
+        SmallVector<Obj, N> inline_v;
+        inline_v.EmplaceBack(ID, "Ivan"s);
+        SmallVector<Obj, N> heap_v(N * 2);
+        heap_v[N].id = ID;
+
+        SmallVector<Obj, N> moved_inline(std::move(inline_v));
+        assert(inline_v.Size() == 0);
+        assert(moved_inline.Size() == 1 && moved_inline[0].id == ID);
+
+        const Obj* heap_data = &heap_v[0];
+        SmallVector<Obj, N> moved_heap(std::move(heap_v));
+        assert(&moved_heap[0] == heap_data);
+
+        moved_inline.Swap(moved_heap);
+        assert(moved_inline.Size() == N * 2 && moved_inline[N].id == ID);
+        assert(moved_heap.Size() == 1 && moved_heap.IsInline() && moved_heap[0].id == ID);
+
+        SmallVector<Obj, N> copy(moved_inline);
+        assert(copy.Size() == N * 2 && copy[N].id == ID);
+        copy = moved_heap;
+        assert(copy.Size() == 1 && copy[0].id == ID);
+        moved_heap = std::move(moved_inline);
+        assert(moved_heap.Size() == N * 2 && !moved_heap.IsInline());
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(N * 2 + 1));
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        SmallVector<TestObj, N> v(N);
+        v.PushBack(v[0]);
+        v.Emplace(v.begin() + 2, v[3]);
+        v.Insert(v.begin(), std::move(v[5]));
+        assert(std::all_of(v.begin(), v.end(), [](const TestObj& obj) {
+            return obj.IsAlive();
+            }));
+    }
+}
+
+template <typename Container>
+std::vector<int> Ids(const Container& v) {
+    std::vector<int> ids;
+    for (const auto& obj : v) {
+        ids.push_back(obj.id);
+    }
+    return ids;
+}
+
+void Test12() {
+    const size_t SIZE = 100'000;
+    {
+        using Alloc = TrackingAllocator<int, false>;
+        Alloc::Stats stats;
+        std::vector<int> batch(SIZE);
+        std::iota(batch.begin(), batch.end(), 0);
+
+        Vector<int, Alloc> v{ Alloc(stats) };
+        v.PushBack(-1);
+        const size_t allocations = stats.allocations;
+        v.Append(batch.begin(), batch.end());
+        assert(stats.allocations == allocations + 1);
+        assert(v.Size() == SIZE + 1);
+        assert(v[0] == -1 && v[1] == 0 && v[SIZE] == static_cast<int>(SIZE - 1));
+
+        v.Insert(v.begin() + 1, batch.data(), batch.data() + 3);
+        assert(v[0] == -1 && v[1] == 0 && v[2] == 1 && v[3] == 2 && v[4] == 0);
+    }
+    {
+        // Хвост длиннее вставляемого диапазона и короче его, вставка с реаллокацией и без
+        Obj::ResetCounters();
+        std::list<Obj> source;
+        for (int i = 100; i < 103; ++i) {
+            source.emplace_back(i);
+        }
+        Vector<Obj> v;
+        v.Reserve(20);
+        for (int i = 0; i < 5; ++i) {
+            v.EmplaceBack(i);
+        }
+        v.Insert(v.begin() + 1, source.begin(), source.end());
+        assert((Ids(v) == std::vector<int>{ 0, 100, 101, 102, 1, 2, 3, 4 }));
+        v.Insert(v.begin() + 6, source.begin(), source.end());
+        assert((Ids(v) == std::vector<int>{ 0, 100, 101, 102, 1, 2, 100, 101, 102, 3, 4 }));
+        assert(v.Capacity() == 20);
+
+        const int num_copied = Obj::num_copied;
+        v.Insert(v.begin(), 10, v[1]);
+        assert(Obj::num_copied == num_copied + 11);
+        assert(v.Size() == 21 && v.Capacity() == 40);
+        assert(v[0].id == 100 && v[9].id == 100 && v[10].id == 0 && v[20].id == 4);
+        v.Insert(v.end(), 2, v[20]);
+        assert(v.Size() == 23 && v[22].id == 4);
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(v.Size() + source.size()));
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        Vector<int> v{ 1, 2, 3 };
+        assert(v.Size() == 3 && v.Capacity() == 3 && v[2] == 3);
+        v = { 4, 5 };
+        assert(v.Size() == 2 && v[0] == 4 && v[1] == 5);
+        v.Assign({ 6, 7, 8, 9 });
+        assert(v.Size() == 4 && v[3] == 9);
+        v.Insert(v.begin() + 2, { 0, 0 });
+        v.Append({ 10 });
+        assert((std::vector<int>(v.begin(), v.end()) == std::vector<int>{ 6, 7, 0, 0, 8, 9, 10 }));
+
+        std::istringstream input("1 2 3");
+        v.Insert(v.begin() + 1, std::istream_iterator<int>(input), std::istream_iterator<int>());
+        assert((std::vector<int>(v.begin(), v.end()) == std::vector<int>{ 6, 1, 2, 3, 7, 0, 0, 8, 9, 10 }));
+
+        const Vector<int> range_copy(v.begin() + 1, v.begin() + 4);
+        assert(range_copy.Size() == 3 && range_copy[0] == 1 && range_copy[2] == 3);
+    }
+}
+
+void Test13() {
+    const size_t SIZE = 10;
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(static_cast<int>(i));
+        }
+        auto pos = v.Erase(v.cbegin() + 2, v.cbegin() + 5);
+        assert(pos == v.begin() + 2);
+        assert((Ids(v) == std::vector<int>{ 0, 1, 5, 6, 7, 8, 9 }));
+        assert(Obj::num_move_assigned == 5);
+        assert(Obj::GetAliveObjectCount() == 7);
+
+        assert(v.Erase(v.cbegin() + 1, v.cbegin() + 1) == v.begin() + 1);
+        assert(v.Size() == 7);
+
+        pos = v.SwapErase(v.cbegin() + 1);
+        assert(pos->id == 9);
+        assert((Ids(v) == std::vector<int>{ 0, 9, 5, 6, 7, 8 }));
+        v.SwapErase(v.cend() - 1);
+        assert((Ids(v) == std::vector<int>{ 0, 9, 5, 6, 7 }));
+
+        assert(v.RemoveIf([](const Obj& obj) {
+            return obj.id % 2 == 1;
+            }) == 3);
+        assert((Ids(v) == std::vector<int>{ 0, 6 }));
+        assert(Obj::GetAliveObjectCount() == 2);
+    }
+    {
+        Vector<int> v;
+        for (int i = 0; i < 100; ++i) {
+            v.PushBack(i);
+        }
+        assert(EraseIf(v, [](int x) {
+            return x >= 10;
+            }) == 90);
+        assert(v.Size() == 10 && v.Capacity() == 128);
+        v.Erase(v.begin(), v.begin() + 3);
+        assert(v.Size() == 7 && v[0] == 3 && v[6] == 9);
+        v.Erase(v.begin(), v.end());
+        assert(v.Size() == 0);
+    }
+}
+
+void Test14() {
+    const size_t SIZE = 1000;
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE, DEFAULT_INIT);
+        assert(v.Size() == SIZE && v.Capacity() == SIZE);
+        assert(Obj::num_default_constructed == static_cast<int>(SIZE));
+        v.ResizeDefaultInit(SIZE * 2);
+        assert(Obj::num_default_constructed == static_cast<int>(SIZE * 2));
+        v.ResizeDefaultInit(1);
+        assert(Obj::GetAliveObjectCount() == 1);
+    }
+    {
+        Vector<int> v(SIZE, DEFAULT_INIT);
+        std::fill(v.begin(), v.end(), 7);
+        v.ResizeUninitialized(SIZE * 3);
+        assert(v.Size() == SIZE * 3);
+        assert(v[SIZE - 1] == 7);
+        std::fill(v.begin() + SIZE, v.end(), 8);
+        assert(v[SIZE * 3 - 1] == 8);
+        v.ResizeUninitialized(10);
+        assert(v.Size() == 10 && v[9] == 7);
+    }
+}
+
+void Test15() {
+    const size_t SIZE = 1000;
+    const auto is_aligned = [](const void* p, size_t alignment) {
+        return reinterpret_cast<std::uintptr_t>(p) % alignment == 0;
+    };
+    {
+        Vector<float, AlignedAllocator<float>> v;
+        static_assert(decltype(v)::ALIGNMENT == CACHE_LINE_ALIGNMENT);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(static_cast<float>(i));
+            assert(is_aligned(v.begin(), CACHE_LINE_ALIGNMENT));
+        }
+        assert(v[SIZE - 1] == static_cast<float>(SIZE - 1));
+    }
+    {
+        Vector<char, AlignedAllocator<char, HUGE_PAGE_ALIGNMENT>> v(SIZE);
+        assert(is_aligned(v.begin(), HUGE_PAGE_ALIGNMENT));
+        v.Reserve(SIZE * 4);
+        assert(is_aligned(v.begin(), HUGE_PAGE_ALIGNMENT));
+    }
+    {
+        struct alignas(128) OverAligned {
+            int value = 0;
+        };
+        Vector<OverAligned> v;
+        Vector<OverAligned, AlignedAllocator<OverAligned, 16>> aligned_v;
+        static_assert(decltype(aligned_v)::ALIGNMENT == 128);
+        for (int i = 0; i < 100; ++i) {
+            v.PushBack(OverAligned{ i });
+            aligned_v.PushBack(OverAligned{ i });
+            assert(is_aligned(v.begin(), 128));
+            assert(is_aligned(aligned_v.begin(), 128));
+        }
+    }
+}
+
+// Перемещаемый побайтово тип, копирование которого может бросить исключение
+struct FragileRelocatable {
+    FragileRelocatable() = default;
+    explicit FragileRelocatable(int id)
+        : id(id) {
+    }
+    FragileRelocatable(const FragileRelocatable& other)
+        : id(other.id) {
+        if (other.throw_on_copy) {
+            throw std::runtime_error("Oops");
+        }
+    }
+    FragileRelocatable& operator=(const FragileRelocatable& other) = default;
+    ~FragileRelocatable() {
+    }
+
+    int id = 0;
+    bool throw_on_copy = false;
+};
+
+template <>
+struct IsTriviallyRelocatable<FragileRelocatable> : std::true_type {};
+
+void Test16() {
+    const size_t SIZE = 10;
+    const int ID = 42;
+    {
+        RelocatableObj::ResetCounters();
+        Vector<RelocatableObj> v;
+        v.Reserve(SIZE * 2);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(static_cast<int>(i));
+        }
+        auto pos = v.Emplace(v.cbegin() + 3, ID);
+        assert(pos == v.begin() + 3);
+        assert(v.Size() == SIZE + 1);
+        assert(v[2].id == 2 && v[3].id == ID && v[4].id == 3 && v[SIZE].id == static_cast<int>(SIZE - 1));
+
+        // Значение, ссылающееся на сдвигаемый элемент, берётся до сдвига
+        v.Emplace(v.cbegin() + 1, v[5]);
+        assert(v[1].id == 4 && v[6].id == 4 && v[2].id == 1);
+        assert(RelocatableObj::num_moved == 0);
+        assert(RelocatableObj::num_copied == 1);
+        assert(RelocatableObj::num_destroyed == 0);
+    }
+    {
+        // Внешнее значение типа T перемещается сразу на место вставки, без временного объекта
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        v.Reserve(SIZE * 2);
+        const int old_num_moved = Obj::num_moved;
+        Obj external(ID);
+        v.Insert(v.cbegin() + 3, std::move(external));
+        assert(v[3].id == ID);
+        assert(Obj::num_moved == old_num_moved + 1);
+        assert(Obj::num_move_assigned == static_cast<int>(SIZE - 3));
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE + 2));
+
+        v.Insert(v.cbegin() + 3, std::move(v[SIZE]));
+        assert(Obj::num_moved == old_num_moved + 3);
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE + 3));
+    }
+    {
+        Vector<FragileRelocatable> v;
+        v.Reserve(SIZE * 2);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(static_cast<int>(i));
+        }
+        FragileRelocatable fragile(ID);
+        fragile.throw_on_copy = true;
+        try {
+            v.Insert(v.cbegin() + 2, fragile);
+            assert(false && "Exception is expected");
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            assert(v[i].id == static_cast<int>(i));
+        }
+    }
+}
+
+void Test17() {
+#ifdef VECTOR_ENABLE_STATS
+    struct StatsProbe {
+        int value = 0;
+    };
+    VectorStats& stats = GetVectorStats<StatsProbe>();
+    stats.Reset();
+    {
+        Vector<StatsProbe> v;
+        for (int i = 0; i < 100; ++i) {
+            v.PushBack(StatsProbe{ i });
+        }
+        v.Reserve(1000);
+        Vector<StatsProbe> empty;
+        empty.Reserve(10);
+    }
+    const VectorStats::Snapshot snapshot = stats.Read();
+    assert(snapshot.allocations == 10);
+    assert(snapshot.bytes_allocated == (255 + 1000 + 10) * sizeof(StatsProbe));
+    assert(snapshot.reallocations == 8);
+    assert(snapshot.elements_relocated == 127 + 100);
+    assert(snapshot.peak_capacity == 1000);
+    assert(snapshot.utilization_histogram[1] == 1);
+    assert(snapshot.utilization_histogram[0] == 1);
+
+    bool found = false;
+    VectorStatsRegistry::Instance().ForEach([&](const VectorStats& registered) {
+        found = found || &registered == &stats;
+    });
+    assert(found);
+    std::ostringstream report;
+    VectorStatsRegistry::Instance().Dump(report);
+    assert(report.str().find("allocations=10 ") != std::string::npos);
+
+    // Выделение, выбросившее исключение, не попадает в статистику
+    {
+        using FailingProbeAllocator = FailingAllocator<StatsProbe>;
+        Vector<StatsProbe, FailingProbeAllocator> v;
+        FailingProbeAllocator::fail_countdown = 1;
+        try {
+            v.Reserve(10);
+            assert(false);
+        }
+        catch (const std::bad_alloc&) {
+        }
+    }
+    assert(stats.Read().allocations == 10);
+#endif
+}
+
+void Test18() {
+    const size_t SIZE = 100;
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        v.Reserve(SIZE * 4);
+        v[SIZE - 1].id = 42;
+        v.ShrinkToFit();
+        assert(v.Size() == SIZE && v.Capacity() == SIZE);
+        assert(v[SIZE - 1].id == 42);
+        assert(Obj::num_moved == static_cast<int>(SIZE) * 2);
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE));
+
+        v.Clear();
+        assert(v.Size() == 0 && v.Capacity() == SIZE);
+        assert(Obj::GetAliveObjectCount() == 0);
+        v.EmplaceBack(1);
+        v.ClearAndRelease();
+        assert(v.Size() == 0 && v.Capacity() == 0);
+        assert(Obj::GetAliveObjectCount() == 0);
+        v.EmplaceBack(1);
+        assert(v.Size() == 1 && v[0].id == 1);
+    }
+    {
+        Vector<int, ReallocAllocator<int>> v;
+        for (int i = 0; i < static_cast<int>(SIZE); ++i) {
+            v.PushBack(i);
         }
-        Dump();
+        v.Resize(10);
+        v.ShrinkToFit();
+        assert(v.Capacity() == 10);
+        assert(v[9] == 9);
+        v.Resize(0);
+        v.ShrinkToFit();
+        assert(v.Capacity() == 0);
     }
-    catch (...) {
+}
+
+void Test19() {
+    using namespace std::literals;
+    using Segmented = SegmentedVector<Obj, 2>;
+    static_assert(Segmented::CHUNK_SIZE == 4);
+    const size_t SIZE = 10;
+    {
+        Obj::ResetCounters();
+        Segmented v;
+        v.PushBack(Obj{});
+        const Obj* first = &v[0];
+        for (size_t i = 1; i < SIZE; ++i) {
+            v.EmplaceBack(static_cast<int>(i), "obj"s);
+        }
+        // Существующие элементы не переносятся и не копируются при росте
+        assert(&v[0] == first);
+        assert(Obj::num_moved == 1);
+        assert(Obj::num_copied == 0);
+        assert(v.Size() == SIZE);
+        assert(v.Capacity() == 12);
+        assert(v.ChunkCount() == 3);
+        assert(v.ChunkSize(0) == 4 && v.ChunkSize(2) == 2);
+        assert(v.ChunkData(1) == &v[4]);
+        for (size_t i = 1; i < SIZE; ++i) {
+            assert(v[i].id == static_cast<int>(i));
+        }
+
+        // Ссылка на собственный элемент как аргумент при добавлении нового блока
+        Segmented w;
+        for (size_t i = 0; i < Segmented::CHUNK_SIZE; ++i) {
+            w.EmplaceBack(static_cast<int>(i));
+        }
+        w.PushBack(w[0]);
+        assert(w[Segmented::CHUNK_SIZE].id == 0);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        SegmentedVector<int, 3> v;
+        for (int i = 0; i < 20; ++i) {
+            v.PushBack(i);
+        }
+        int sum = 0;
+        size_t visited = 0;
+        v.ForEachChunk([&](const int* data, size_t count) {
+            sum += std::accumulate(data, data + count, 0);
+            visited += count;
+        });
+        assert(visited == 20 && sum == 190);
+
+        assert(std::accumulate(v.begin(), v.end(), 0) == 190);
+        assert(v.end() - v.begin() == 20);
+        SegmentedVector<int, 3>::const_iterator it = v.begin() + 10;
+        assert(*it == 10 && it[3] == 13);
+
+        const SegmentedVector<int, 3> copy(v);
+        assert(std::equal(copy.begin(), copy.end(), v.begin()));
+
+        SegmentedVector<int, 3> moved(std::move(v));
+        assert(v.Size() == 0 && moved.Size() == 20);
+        moved.PopBack();
+        assert(moved.Size() == 19 && moved[18] == 18);
+
+        moved.Clear();
+        assert(moved.Size() == 0 && moved.Capacity() == 24);
+        moved.Reserve(40);
+        assert(moved.Capacity() == 40);
+    }
+    {
+        // Без распространения аллокатора присваивание из вектора с другим аллокатором
+        // копирует и перемещает элементы в блоки аллокатора lhs
+        using Alloc = TrackingAllocator<Obj, false>;
+        using TrackedSegmented = SegmentedVector<Obj, 2, Alloc>;
+        Alloc::Stats lhs_stats;
+        Alloc::Stats rhs_stats;
+        Obj::ResetCounters();
+        {
+            TrackedSegmented lhs{ Alloc(lhs_stats) };
+            lhs.EmplaceBack(0);
+            TrackedSegmented rhs{ Alloc(rhs_stats) };
+            for (size_t i = 0; i < SIZE; ++i) {
+                rhs.EmplaceBack(static_cast<int>(i));
+            }
+            const size_t rhs_bytes = rhs_stats.bytes_in_use;
+
+            lhs = rhs;
+            assert(lhs.Size() == SIZE && lhs[SIZE - 1].id == static_cast<int>(SIZE - 1));
+            assert(lhs_stats.bytes_in_use == lhs.Capacity() * sizeof(Obj));
+            assert(rhs_stats.bytes_in_use == rhs_bytes);
+
+            TrackedSegmented other{ Alloc(lhs_stats) };
+            other = std::move(rhs);
+            assert(other.Size() == SIZE && rhs.Size() == 0);
+            assert(Obj::num_moved >= static_cast<int>(SIZE));
+            assert(lhs_stats.bytes_in_use == (lhs.Capacity() + other.Capacity()) * sizeof(Obj));
+            assert(rhs_stats.bytes_in_use == rhs_bytes);
+        }
+        assert(lhs_stats.bytes_in_use == 0);
+        assert(rhs_stats.bytes_in_use == 0);
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        // С распространением аллокаторы переходят вместе с блоками
+        using Alloc = TrackingAllocator<int, true>;
+        Alloc::Stats lhs_stats;
+        Alloc::Stats rhs_stats;
+        {
+            SegmentedVector<int, 2, Alloc> lhs{ Alloc(lhs_stats) };
+            SegmentedVector<int, 2, Alloc> rhs{ Alloc(rhs_stats) };
+            rhs.PushBack(1);
+            lhs.Swap(rhs);
+            assert(lhs.Size() == 1 && rhs.Size() == 0);
+            lhs.PushBack(2);
+            assert(rhs_stats.allocations == 1 && lhs_stats.allocations == 0);
+            rhs = std::move(lhs);
+            assert(rhs.Size() == 2 && rhs[1] == 2);
+            rhs.PushBack(3);
+            rhs.PushBack(4);
+            rhs.PushBack(5);
+            assert(rhs_stats.allocations == 2 && lhs_stats.allocations == 0);
+        }
+        assert(lhs_stats.bytes_in_use == 0 && rhs_stats.bytes_in_use == 0);
+    }
+}
+
+void Test20() {
+    using namespace std::literals;
+    {
+        Obj::ResetCounters();
+        ConcurrentVector<Obj, 2> v;
+        static_assert(decltype(v)::FIRST_SEGMENT_SIZE == 4);
+        for (int i = 0; i < 20; ++i) {
+            assert(v.EmplaceBack(i, "obj"s) == static_cast<size_t>(i));
+        }
+        const Obj* first = &v[0];
+        v.PushBack(Obj(20));
+        assert(&v[0] == first);
+        assert(v.Size() == 21 && v[13].id == 13 && v[20].id == 20);
+
+        // Бросивший конструктор не занимает позицию: значение создаётся до резервирования
+        Obj::default_construction_throw_countdown = 1;
+        try {
+            v.EmplaceBack();
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(v.EmplaceBack(21) == 21);
+        assert(v.Size() == 22);
+
+        size_t visited = 0;
+        std::vector<size_t> chunk_sizes;
+        v.ForEachChunk([&](const Obj* data, size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                assert(data[i].id == static_cast<int>(visited + i));
+            }
+            visited += count;
+            chunk_sizes.push_back(count);
+        });
+        assert(visited == 22);
+        assert((chunk_sizes == std::vector<size_t>{ 4, 8, 10 }));
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        // Позиция, для которой не удалось выделить сегмент, остаётся разрывом. Элементы за ним
+        // не публикуются, но разрушаются вместе с вектором
+        Obj::ResetCounters();
+        {
+            ConcurrentVector<Obj, 2, FailingAllocator<Obj>> v;
+            for (int i = 0; i < 4; ++i) {
+                v.EmplaceBack(i);
+            }
+            FailingAllocator<Obj>::fail_countdown = 1;
+            try {
+                v.EmplaceBack(4);
+                assert(false);
+            }
+            catch (const std::bad_alloc&) {
+            }
+            assert(v.EmplaceBack(5) == 5);
+            assert(v.EmplaceBack(6) == 6);
+            assert(v.Size() == 4);
+            assert(Obj::GetAliveObjectCount() == 6);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        const size_t THREADS = 8;
+        const size_t PER_THREAD = 20000;
+        ConcurrentVector<size_t> v;
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < THREADS; ++t) {
+            threads.emplace_back([&v, t] {
+                for (size_t i = 0; i < PER_THREAD; ++i) {
+                    const size_t index = v.PushBack(t * PER_THREAD + i);
+                    // Элемент читается по индексу, как только префикс до него опубликован
+                    const size_t size = v.Size();
+                    if (index < size) {
+                        assert(v[index] == t * PER_THREAD + i);
+                    }
+                }
+            });
+        }
+        // Читатель, работающий одновременно с писателями, видит только созданные элементы
+        size_t observed = 0;
+        while (observed < THREADS * PER_THREAD) {
+            const size_t size = v.Size();
+            assert(size >= observed);
+            for (size_t i = observed; i < size; ++i) {
+                assert(v[i] < THREADS * PER_THREAD);
+            }
+            observed = size;
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        assert(v.Size() == THREADS * PER_THREAD);
+        std::vector<bool> seen(THREADS * PER_THREAD);
+        v.ForEachChunk([&seen](const size_t* data, size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                assert(!seen[data[i]]);
+                seen[data[i]] = true;
+            }
+        });
+    }
+}
+
+// Счётчики атомарные: объекты создаются и разрушаются из нескольких потоков
+struct ParallelObj {
+    ParallelObj() {
+        Count();
+    }
+    ParallelObj(const ParallelObj& other)
+        : value(other.value) {
+        Count();
+    }
+    ParallelObj& operator=(const ParallelObj&) = default;
+    ~ParallelObj() {
+        --alive;
+    }
+
+    void Count() {
+        if (constructed.fetch_add(1) == throw_at) {
+            throw std::runtime_error("Oops");
+        }
+        ++alive;
+    }
+
+    static void Reset(int throw_at_construction = -1) {
+        alive = 0;
+        constructed = 0;
+        throw_at = throw_at_construction;
+    }
+
+    int value = 7;
+
+    static inline std::atomic<int> alive{ 0 };
+    static inline std::atomic<int> constructed{ 0 };
+    static inline int throw_at = -1;
+};
+
+void Test21() {
+    // Участок не меньше PARALLEL_MIN_CHUNK_BYTES, так что четыре потока получат по участку
+    const size_t SIZE = PARALLEL_MIN_CHUNK_BYTES / sizeof(ParallelObj) * 4;
+    const ParallelTag FOUR_THREADS(4);
+    {
+        ParallelObj::Reset();
+        Vector<ParallelObj> v(FOUR_THREADS, SIZE);
+        assert(v.Size() == SIZE && ParallelObj::alive == static_cast<int>(SIZE));
+        assert(std::all_of(v.begin(), v.end(), [](const ParallelObj& obj) {
+            return obj.value == 7;
+        }));
+
+        v[SIZE - 1].value = 42;
+        Vector<ParallelObj> copy(FOUR_THREADS, v);
+        assert(copy.Size() == SIZE && copy[SIZE - 1].value == 42);
+        assert(ParallelObj::alive == static_cast<int>(2 * SIZE));
+
+        Vector<ParallelObj> small(3);
+        small.CopyFrom(FOUR_THREADS, v);
+        assert(small.Size() == SIZE && small[SIZE - 1].value == 42);
+        assert(ParallelObj::alive == static_cast<int>(3 * SIZE));
+
+        small.Clear(FOUR_THREADS);
+        copy.Clear(PARALLEL);
+        assert(small.Size() == 0 && ParallelObj::alive == static_cast<int>(SIZE));
+    }
+    assert(ParallelObj::alive == 0);
+    {
+        // Исключение в одном из потоков: созданные остальными потоками элементы разрушаются
+        ParallelObj::Reset(static_cast<int>(SIZE / 2));
+        try {
+            Vector<ParallelObj> v(FOUR_THREADS, SIZE);
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(ParallelObj::alive == 0);
+
+        ParallelObj::Reset();
+        Vector<ParallelObj> v(FOUR_THREADS, SIZE);
+        Vector<ParallelObj> target(10);
+        ParallelObj::throw_at = ParallelObj::constructed + static_cast<int>(SIZE / 3);
+        try {
+            target.CopyFrom(FOUR_THREADS, v);
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(target.Size() == 10);
+        assert(ParallelObj::alive == static_cast<int>(SIZE + 10));
+    }
+    {
+        // Тривиальные типы и маленькие векторы
+        Vector<int> zeros(PARALLEL, SIZE);
+        assert(std::all_of(zeros.begin(), zeros.end(), [](int x) {
+            return x == 0;
+        }));
+        Vector<int> tiny(PARALLEL, 5);
+        assert(tiny.Size() == 5 && tiny[4] == 0);
+        Vector<int> tiny_copy(PARALLEL, tiny);
+        assert(tiny_copy.Size() == 5);
+    }
+}
+
+struct Record {
+    uint64_t id = 0;
+    double value = 0.0;
+    char tag[8] = "rec";
+};
+
+void Test22() {
+    const std::string path = "/tmp/advanced_vector_test_" + std::to_string(::getpid()) + ".bin";
+    ::unlink(path.c_str());
+    const size_t SIZE = 1000;
+    {
+        MappedVector<Record> mv(path);
+        assert(mv->Size() == 0);
+        for (size_t i = 0; i < SIZE; ++i) {
+            mv->PushBack(Record{ i, i * 0.5, "rec" });
+        }
+    }
+    {
+        // Повторное открытие: элементы доступны сразу, без чтения и копирования
+        MappedVector<Record> mv(path);
+        assert(mv->Size() == SIZE);
+        assert(mv->Capacity() >= SIZE);
+        assert(reinterpret_cast<uintptr_t>(mv->View().Data()) % PAGE_ALIGNMENT == 0);
+        for (size_t i = 0; i < SIZE; ++i) {
+            assert((*mv)[i].id == i && (*mv)[i].value == i * 0.5);
+        }
+        assert(std::string((*mv)[SIZE - 1].tag) == "rec");
+
+        // Рост через ftruncate и mremap, элементы не копируются конструкторами
+        mv->Reserve(SIZE * 100);
+        assert(mv->Size() == SIZE && mv->Capacity() == SIZE * 100);
+        (*mv)[0].id = 42;
+        mv.Sync();
+
+        // Копия вектора живёт в куче и не меняет файл
+        MappedVector<Record>::VectorType copy(*mv);
+        copy[1].id = 77;
+        assert((*mv)[1].id == 1);
+    }
+    {
+        MappedVector<Record> mv(path, MapMode::PRIVATE);
+        assert(mv->Size() == SIZE && (*mv)[0].id == 42);
+        (*mv)[0].id = 0;
+        // Рост частного отображения сверх длины файла переносит буфер в кучу
+        const size_t capacity = mv->Capacity();
+        for (size_t i = SIZE; i <= capacity; ++i) {
+            mv->PushBack(Record{ i });
+        }
+        assert((*mv)[capacity].id == capacity && (*mv)[SIZE - 1].id == SIZE - 1);
+    }
+    {
+        // Изменения в режиме PRIVATE не попали в файл
+        MappedVector<Record> mv(path);
+        assert(mv->Size() == SIZE && (*mv)[0].id == 42);
+        mv->ShrinkToFit();
+        assert(mv->Capacity() == SIZE && (*mv)[SIZE - 1].id == SIZE - 1);
+    }
+    try {
+        MappedVector<uint32_t> wrong(path);
+        assert(false);
+    }
+    catch (const std::runtime_error&) {
+    }
+    try {
+        MappedVector<Record> missing(path + ".missing", MapMode::PRIVATE);
+        assert(false);
+    }
+    catch (const std::system_error&) {
+    }
+    ::unlink(path.c_str());
+}
+
+void Test23() {
+    const size_t SIZE = 100000;
+    Vector<Record> records;
+    for (size_t i = 0; i < SIZE; ++i) {
+        records.PushBack(Record{ i, i * 0.25, "io" });
+    }
+    {
+        const std::string path = "/tmp/advanced_vector_io_" + std::to_string(::getpid()) + ".bin";
+        const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        assert(fd >= 0);
+        ::unlink(path.c_str());
+
+        WriteTo(fd, records);
+        WriteTo(fd, Vector<Record>{});
+        assert(::lseek(fd, 0, SEEK_END) == static_cast<off_t>(2 * sizeof(VectorIoHeader) + SIZE * sizeof(Record)));
+        ::lseek(fd, 0, SEEK_SET);
+
+        Vector<Record> loaded(3);
+        ReadFrom(fd, loaded);
+        assert(loaded.Size() == SIZE);
+        assert(std::memcmp(loaded.begin(), records.begin(), SIZE * sizeof(Record)) == 0);
+        ReadFrom(fd, loaded);
+        assert(loaded.Size() == 0);
+
+        // Конец файла посреди данных
+        try {
+            ReadFrom(fd, loaded);
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(loaded.Size() == 0);
+        ::close(fd);
+    }
+    {
+        std::stringstream stream;
+        WriteTo(stream, records);
+        Vector<Record> loaded;
+        ReadFrom(stream, loaded);
+        assert(loaded.Size() == SIZE && loaded[SIZE - 1].id == SIZE - 1);
+
+        // Другой тип элементов отклоняется по заголовку
+        std::stringstream ints;
+        WriteTo(ints, Vector<uint32_t>{ 1, 2, 3 });
+        try {
+            ReadFrom(ints, loaded);
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(loaded.Size() == 0);
+
+        std::string truncated = stream.str();
+        truncated.resize(truncated.size() - 1);
+        std::istringstream short_stream(truncated);
+        try {
+            ReadFrom(short_stream, loaded);
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(loaded.Size() == 0);
+    }
+    {
+        // Заголовок с огромным числом элементов не должен приводить к огромному выделению памяти
+        auto write_header = [](auto&& write, uint64_t count) {
+            VectorIoHeader header = VectorIoHeader::For<Record>(0);
+            header.count = count;
+            write(&header, sizeof(header));
+        };
+        for (const uint64_t count : { uint64_t(1) << 40, std::numeric_limits<uint64_t>::max() }) {
+            std::stringstream stream;
+            write_header([&stream](const void* data, size_t size) {
+                stream.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+            }, count);
+            Vector<Record> loaded;
+            try {
+                ReadFrom(stream, loaded);
+                assert(false);
+            }
+            catch (const std::runtime_error&) {
+            }
+            assert(loaded.Size() == 0 && loaded.Capacity() == 0);
+
+            // Канал: остаток входа неизвестен, вектор растёт только по мере чтения
+            int fds[2];
+            assert(::pipe(fds) == 0);
+            auto write_fd = [fd = fds[1]](const void* data, size_t size) {
+                [[maybe_unused]] const ssize_t written = ::write(fd, data, size);
+                assert(written == static_cast<ssize_t>(size));
+            };
+            write_header(write_fd, count);
+            write_fd(records.View().Data(), 3 * sizeof(Record));
+            ::close(fds[1]);
+            try {
+                ReadFrom(fds[0], loaded);
+                assert(false);
+            }
+            catch (const std::runtime_error&) {
+            }
+            assert(loaded.Size() == 0);
+            assert(loaded.Capacity() * sizeof(Record) <= 2 * vector_io_detail::READ_CHUNK_BYTES);
+            ::close(fds[0]);
+        }
+    }
+}
+
+void Test24() {
+    using namespace std::literals;
+    {
+        // Буфер из C API: память выделена malloc и освобождается вектором через ReallocAllocator
+        const size_t SIZE = 10;
+        const size_t CAPACITY = 16;
+        int* raw = static_cast<int*>(std::malloc(CAPACITY * sizeof(int)));
+        std::iota(raw, raw + SIZE, 0);
+
+        Vector<int, ReallocAllocator<int>> v{ 100, 200 };
+        v.Adopt(raw, SIZE, CAPACITY);
+        assert(v.begin() == raw && v.Size() == SIZE && v.Capacity() == CAPACITY);
+        assert(v[SIZE - 1] == 9);
+        v.PushBack(10);
+        assert(v.Size() == SIZE + 1);
+
+        auto released = v.Release();
+        assert(v.Size() == 0 && v.Capacity() == 0 && v.begin() == nullptr);
+        assert(released.size == SIZE + 1 && released.capacity >= CAPACITY && released.data[SIZE] == 10);
+        std::free(released.data);
+    }
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v;
+        v.EmplaceBack(1, "one"s);
+        v.EmplaceBack(2, "two"s);
+        const Obj* data = v.begin();
+        auto released = v.Release();
+        assert(released.data == data && released.size == 2);
+        assert(Obj::GetAliveObjectCount() == 2);
+
+        // Буфер возвращается в другой вектор с тем же аллокатором без копирования элементов
+        Vector<Obj> other(3);
+        other.Adopt(released.data, released.size, released.capacity);
+        assert(other.begin() == data && other.Size() == 2 && other[1].name == "two"s);
+        assert(Obj::num_copied == 0 && Obj::GetAliveObjectCount() == 2);
+
+        released = other.Release();
+        std::destroy_n(released.data, released.size);
+        std::allocator<Obj>().deallocate(released.data, released.capacity);
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+}
+
+namespace {
+
+    // Принимает любой участок без копирования
+    int Sum(VectorView<const int> view) {
+        return std::accumulate(view.begin(), view.end(), 0);
+    }
+
+}  // namespace
+
+void Test25() {
+    Vector<int> v(10);
+    std::iota(v.begin(), v.end(), 0);
+    {
+        assert(Sum(v) == 45);
+        VectorView<int> tail = v.Subspan(7);
+        assert(tail.Size() == 3 && tail[0] == 7 && tail.Data() == v.begin() + 7);
+        tail[0] = 70;
+        assert(v[7] == 70);
+        v[7] = 7;
+
+        const Vector<int>& cv = v;
+        VectorView<const int> middle = cv.Subspan(2, 4);
+        assert(Sum(middle) == 2 + 3 + 4 + 5);
+        assert(Sum(middle.First(2)) == 5 && Sum(middle.Last(1)) == 5);
+        assert(Sum(middle.Subspan(1, 2)) == 7);
+        assert(v.Subspan(10).Empty() && v.Subspan(0, 0).Empty());
+    }
+    {
+        // Один столбец матрицы 3x4, хранящейся по строкам
+        StridedView<int> column = v.Subspan(1).Strided(4);
+        assert(column.Size() == 3);
+        assert(column[0] == 1 && column[1] == 5 && column[2] == 9);
+        assert(std::accumulate(column.begin(), column.end(), 0) == 15);
+        assert(column.end() - column.begin() == 3);
+        for (int& x : column) {
+            x = -x;
+        }
+        assert(v[5] == -5 && v[6] == 6);
+        for (int& x : column) {
+            x = -x;
+        }
+        assert(v.Strided(3).Size() == 4 && v.Strided(20).Size() == 1);
+    }
+    {
+        auto chunks = v.Chunks(4);
+        assert(chunks.Size() == 3);
+        std::vector<int> sums;
+        for (VectorView<int> chunk : chunks) {
+            sums.push_back(Sum(chunk));
+        }
+        assert((sums == std::vector<int>{ 6, 22, 17 }));
+        assert(chunks[2].Size() == 2 && chunks[2][1] == 9);
+        assert(Vector<int>().Chunks(4).Size() == 0);
+
+        const auto no_chunks = v.Chunks(0);
+        assert(no_chunks.Size() == 0 && no_chunks.begin() == no_chunks.end());
+        for ([[maybe_unused]] VectorView<int> chunk : no_chunks) {
+            assert(false);
+        }
+    }
+#if __cplusplus >= 202002L && defined(__cpp_lib_span)
+    {
+        std::span<const int> span = v.Subspan(2, 3);
+        assert(span.size() == 3 && span[0] == 2);
+    }
+#endif
+}
+
+void Test26() {
+    // Данные с нечётным смещением начала, чтобы у ядер были и пролог, и хвост
+    Vector<int32_t, AlignedAllocator<int32_t, 64>> ints(1000 + 16);
+    Vector<float, AlignedAllocator<float, 64>> floats(ints.Size());
+    for (size_t i = 0; i < ints.Size(); ++i) {
+        ints[i] = static_cast<int32_t>((i * 7919) % 1000) - 500;
+        floats[i] = static_cast<float>(ints[i]) * 0.5f;
+    }
+    ints[900] = std::numeric_limits<int32_t>::max();
+    ints[901] = std::numeric_limits<int32_t>::max();
+
+    const SimdLevel detected = GetSimdLevel();
+    for (int level = static_cast<int>(SimdLevel::SCALAR); level <= static_cast<int>(detected); ++level) {
+        assert(SetSimdLevel(static_cast<SimdLevel>(level)) == static_cast<SimdLevel>(level));
+        for (size_t offset : { 0, 1, 3, 15 }) {
+            for (size_t size : { 0, 1, 5, 16, 17, 63, 64, 100, 1000 }) {
+                const VectorView<const int32_t> iv = ints.Subspan(offset, size);
+                const VectorView<const float> fv = floats.Subspan(offset, size);
+
+                const int32_t needle = size > 0 ? iv[size * 3 / 4] : 0;
+                const size_t expected_find = std::find(iv.begin(), iv.end(), needle) - iv.begin();
+                assert(simd::Find(iv, needle) == (expected_find == size ? VectorView<const int32_t>::NPOS : expected_find));
+                assert(simd::Find(iv, 12345) == VectorView<const int32_t>::NPOS);
+                assert(simd::Count(iv, needle) == static_cast<size_t>(std::count(iv.begin(), iv.end(), needle)));
+                assert(simd::Count(fv, needle * 0.5f) == static_cast<size_t>(std::count(fv.begin(), fv.end(), needle * 0.5f)));
+                if (size > 0) {
+                    assert(simd::Find(fv, fv[size - 1]) == static_cast<size_t>(std::find(fv.begin(), fv.end(), fv[size - 1]) - fv.begin()));
+                    const auto [imin, imax] = std::minmax_element(iv.begin(), iv.end());
+                    assert(simd::MinMax(iv).min == *imin && simd::MinMax(iv).max == *imax);
+                    const auto [fmin, fmax] = std::minmax_element(fv.begin(), fv.end());
+                    assert(simd::MinMax(fv).min == *fmin && simd::MinMax(fv).max == *fmax);
+                }
+
+                // Сумма двух INT32_MAX не переполняется; сумма половинок целых точна во float
+                const int64_t expected_sum = std::accumulate(iv.begin(), iv.end(), int64_t{ 0 });
+                assert(simd::Sum(iv) == expected_sum);
+                assert(simd::Sum(fv) == std::accumulate(fv.begin(), fv.end(), 0.0f));
+                const VectorView<const int32_t> other = ints.Subspan(16 - offset, size);
+                int64_t expected_dot = 0;
+                for (size_t i = 0; i < size; ++i) {
+                    expected_dot += static_cast<int64_t>(iv[i]) * other[i];
+                }
+                assert(simd::Dot(iv, other) == expected_dot);
+                const VectorView<const float> fother = floats.Subspan(2, size);
+                // Порядок сложений ядер отличается от последовательного: сравнение с допуском
+                const double expected_fdot = std::inner_product(fv.begin(), fv.end(), fother.begin(), 0.0);
+                assert(std::abs(simd::Dot(fv, fother) - expected_fdot) <= 1e-6 * std::abs(expected_fdot) + 1e-3);
+
+                Vector<int32_t> itransformed(size + 1);
+                simd::Transform(iv, itransformed.Subspan(1), 3, -1);
+                for (size_t i = 0; i < size; ++i) {
+                    assert(itransformed[i + 1] == static_cast<int32_t>(static_cast<uint32_t>(iv[i]) * 3u - 1u));
+                }
+                Vector<float> ftransformed(size);
+                simd::Transform(fv, ftransformed, 2.0f, 1.0f);
+                for (size_t i = 0; i < size; ++i) {
+                    assert(ftransformed[i] == fv[i] * 2.0f + 1.0f);
+                }
+
+                simd::Fill(itransformed.Subspan(1), 42);
+                assert(itransformed[0] == 0 && simd::Count(itransformed, 42) == size);
+                simd::Fill(ftransformed, -1.5f);
+                assert(simd::Count(ftransformed, -1.5f) == size);
+            }
+        }
+    }
+    SetSimdLevel(detected);
+}
+
+void Test27() {
+    using namespace std::literals;
+    {
+        SoAVector<int32_t, double, std::string> v;
+        static_assert(decltype(v)::ROW_SIZE == sizeof(int32_t) + sizeof(double) + sizeof(std::string));
+        for (int32_t i = 0; i < 100; ++i) {
+            auto [id, value, name] = v.EmplaceBack(i, i * 1.5, "row"s + std::to_string(i));
+            assert(id == i && value == i * 1.5 && name == "row"s + std::to_string(i));
+        }
+        assert(v.Size() == 100 && v.Capacity() >= 100);
+
+        // Колонка - непрерывный участок, её можно сканировать векторными алгоритмами
+        assert(simd::Sum(v.Column<0>()) == 99 * 100 / 2);
+        assert(simd::Find(v.Column<0>(), 42) == 42);
+        assert(v.Column<2>()[7] == "row7"s);
+
+        for (auto [id, value, name] : v) {
+            value = id * 2.0;
+            name += "!";
+        }
+        assert(v.Get<1>(10) == 20.0 && v.Get<2>(10) == "row10!"s);
+
+        // Аргумент ссылается на элемент вектора, который переносится при росте
+        while (v.Size() < v.Capacity()) {
+            v.EmplaceBack(0, 0.0, ""s);
+        }
+        v.EmplaceBack(v.Get<0>(5), v.Get<1>(5), v.Get<2>(5));
+        assert(v.Get<2>(v.Size() - 1) == "row5!"s && v.Get<0>(v.Size() - 1) == 5);
+
+        const auto copy = v;
+        assert(copy.Size() == v.Size() && std::get<2>(copy[99]) == "row99!"s);
+        size_t rows = 0;
+        for (auto it = copy.begin(); it != copy.end(); ++it) {
+            ++rows;
+        }
+        assert(rows == copy.Size() && copy.end() - copy.begin() == static_cast<std::ptrdiff_t>(rows));
+
+        auto moved = std::move(v);
+        assert(v.Size() == 0 && moved.Size() == copy.Size());
+        moved.PopBack();
+        assert(moved.Size() == copy.Size() - 1);
+        moved.Clear();
+        assert(moved.Size() == 0 && moved.Capacity() >= copy.Size());
+    }
+    {
+        // Ошибка копирования одной колонки не меняет вектор
+        Obj::ResetCounters();
+        SoAVector<int, Obj> v;
+        v.Reserve(4);
+        for (int i = 0; i < 4; ++i) {
+            v.EmplaceBack(i, i);
+        }
+        assert(Obj::num_moved == 0 && Obj::num_copied == 0);
+        try {
+            v.Get<1>(2).throw_on_copy = true;
+            SoAVector<int, Obj> copy(v);
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(Obj::GetAliveObjectCount() == 4);
+        v.Get<1>(2).throw_on_copy = false;
+
+        // Obj перемещается без исключений, поэтому рост переносит колонку перемещением
+        const int copied = Obj::num_copied;
+        v.EmplaceBack(4, 4);
+        assert(v.Size() == 5 && Obj::num_moved == 4 && Obj::num_copied == copied);
+        assert(v.Get<1>(3).id == 3 && v.Get<1>(4).id == 4);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+void Test28() {
+    using namespace std::literals;
+    Arena arena(1024);
+    {
+        ArenaVector<int> v{ ArenaAllocator<int>(arena) };
+        v.PushBack(0);
+        const int* data = v.begin();
+        // Последний выделенный в арене буфер растёт на месте
+        for (int i = 1; i < 100; ++i) {
+            v.PushBack(i);
+        }
+        assert(v.begin() == data && v[99] == 99);
+
+        ArenaVector<int> w(10, ArenaAllocator<int>(arena));
+        assert(w.View().Data() >= v.View().Data() + v.Capacity());
+        // Теперь буфер v не последний и переносится, прежний просто остаётся в арене
+        v.Reserve(1000);
+        assert(v.begin() != data && v[99] == 99);
+        assert(arena.BytesUsed() >= (1000 + 10 + 100) * sizeof(int));
+
+        // Копия использует ту же арену
+        ArenaVector<int> copy(v);
+        assert(copy.GetAllocator() == v.GetAllocator() && copy[50] == 50);
+
+        // При копирующем присваивании из другой арены элементы копируются в арену lhs
+        Arena other_arena(1024);
+        ArenaVector<int> other(5, ArenaAllocator<int>(other_arena));
+        const size_t other_used = other_arena.BytesUsed();
+        other = v;
+        assert(other.Size() == v.Size() && other[99] == 99);
+        assert(&other.GetAllocator().GetArena() == &other_arena);
+        assert(other_arena.BytesUsed() >= other_used + v.Size() * sizeof(int));
+        v = other;
+        assert(&v.GetAllocator().GetArena() == &arena && v[99] == 99);
+    }
+    {
+        Obj::ResetCounters();
+        ArenaVector<Obj> objects{ ArenaAllocator<Obj>(arena) };
+        for (int i = 0; i < 10; ++i) {
+            objects.EmplaceBack(i, "arena"s);
+        }
+        assert(Obj::GetAliveObjectCount() == 10);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+
+    const size_t reserved = arena.BytesReserved();
+    arena.Reset();
+    assert(arena.BytesUsed() == 0 && arena.BytesReserved() == reserved);
+    {
+        // После Reset память блоков используется повторно без новых выделений
+        ArenaVector<double> v(50, ArenaAllocator<double>(arena));
+        assert(v.Size() == 50 && v[49] == 0.0);
+        assert(arena.BytesReserved() == reserved);
+
+        // Выравнивание учитывается
+        Vector<__int128, ArenaAllocator<__int128>> wide(3, ArenaAllocator<__int128>(arena));
+        assert(reinterpret_cast<uintptr_t>(wide.View().Data()) % alignof(__int128) == 0);
+    }
+    arena.Reset();
+    {
+        // Запрос больше блока получает собственный блок
+        ArenaVector<char> big(5000, ArenaAllocator<char>(arena));
+        assert(big.Size() == 5000 && arena.BytesReserved() > reserved);
+    }
+    {
+        // Запрос, размер блока под который переполняет size_t, отклоняется, а не возвращает nullptr
+        ArenaVector<int> v{ ArenaAllocator<int>(arena) };
+        v.PushBack(1);
+        try {
+            v.Reserve(std::numeric_limits<size_t>::max() / sizeof(int) - 1);
+            assert(false);
+        }
+        catch (const std::bad_alloc&) {
+        }
+        assert(v.Size() == 1 && v[0] == 1 && v.Capacity() < 1000);
+        try {
+            arena.Allocate(std::numeric_limits<size_t>::max() - 8, 16);
+            assert(false);
+        }
+        catch (const std::bad_alloc&) {
+        }
+    }
+}
+
+void Test29() {
+    BufferPool::Trim();
+    {
+        // Буфер, освобождённый одним вектором, достаётся следующему
+        PooledVector<int> warmup;
+        for (int i = 0; i < 1000; ++i) {
+            warmup.PushBack(i);
+        }
+    }
+    const BufferPool::Stats warm = BufferPool::GetStats();
+    for (int round = 0; round < 100; ++round) {
+        PooledVector<int> v;
+        for (int i = 0; i < 1000; ++i) {
+            v.PushBack(i);
+        }
+        PooledVector<int> copy(v);
+        assert(copy[999] == 999);
+    }
+    assert(BufferPool::GetStats().system_allocations == warm.system_allocations + 1);
+    {
+        // Буфер округлён до степени двойки, рост в пределах класса идёт на месте
+        static_assert(sizeof(Record) == 24);
+        PooledVector<Record> records;
+        records.Reserve(3);
+        const Record* data = records.begin();
+        records.Reserve(5);
+        assert(records.begin() == data && records.Capacity() == 5);
+        records.Reserve(6);
+        assert(records.Capacity() == 6);
+        static_assert(BufferPool::UsableSize(72) == 128 && BufferPool::UsableSize(128) == 128);
+    }
+    {
+        // Кеш завершившегося потока переходит в общий пул
+        BufferPool::Trim();
+        std::thread([] {
+            PooledVector<char> v(64 * 1024);
+        }).join();
+        const size_t allocations = BufferPool::GetStats().system_allocations;
+        PooledVector<char> v(64 * 1024);
+        assert(BufferPool::GetStats().system_allocations == allocations);
+    }
+    {
+        // Большие буферы не кешируются
+        const BufferPool::Stats before = BufferPool::GetStats();
+        {
+            PooledVector<char> big(BufferPool::MAX_POOLED_BYTES + 1);
+        }
+        const BufferPool::Stats after = BufferPool::GetStats();
+        assert(after.system_allocations == before.system_allocations + 1);
+        assert(after.system_deallocations == before.system_deallocations + 1);
+    }
+    {
+        // Переполненный кеш потока сбрасывается в общий пул, а избыток - системе
+        Vector<PooledVector<char>> many;
+        for (int i = 0; i < 200; ++i) {
+            many.EmplaceBack(1024 * 1024);
+        }
+        const size_t deallocations = BufferPool::GetStats().system_deallocations;
+        many.Clear();
+        assert(BufferPool::GetStats().system_deallocations > deallocations);
+    }
+    BufferPool::Trim();
+}
+
+void Test30() {
+#if VECTOR_HAS_CONSTEXPR
+    {
+        // Vector во время компиляции: рост, перенос вложенных векторов, копирование и разрушение
+        constexpr auto sum_of_squares = [](int n) {
+            Vector<Vector<int>> rows;
+            for (int i = 0; i < n; ++i) {
+                rows.EmplaceBack(static_cast<size_t>(i));
+                for (int& x : rows[i]) {
+                    x = i;
+                }
+            }
+            Vector<Vector<int>> copy(rows);
+            copy.PushBack(Vector<int>{ 1, 2, 3 });
+            int sum = 0;
+            for (const Vector<int>& row : copy) {
+                for (int x : row) {
+                    sum += x;
+                }
+            }
+            return sum;
+        };
+        static_assert(sum_of_squares(10) == 285 + 6);
+
+        // Таблица поиска, построенная через Vector и скопированная в std::array
+        constexpr auto squares = [] {
+            Vector<int> v;
+            for (int i = 0; i < 8; ++i) {
+                v.PushBack(i * i);
+            }
+            v.Resize(10);
+            std::array<int, 10> table{};
+            std::copy(v.begin(), v.end(), table.begin());
+            return table;
+        }();
+        static_assert(squares[7] == 49 && squares[9] == 0);
+    }
+    {
+        // StaticVector сохраняется в constexpr-переменной
+        constexpr StaticVector<int, 16> primes = [] {
+            StaticVector<int, 16> result;
+            for (int n = 2; !result.Full(); ++n) {
+                bool prime = true;
+                for (int p : result) {
+                    prime = prime && n % p != 0;
+                }
+                if (prime) {
+                    result.PushBack(n);
+                }
+            }
+            return result;
+        }();
+        static_assert(primes.Size() == 16 && primes[3] == 7 && primes[15] == 53);
+        assert(std::accumulate(primes.begin(), primes.end(), 0) == 381);
+    }
+#endif
+    using namespace std::literals;
+    {
+        // Элементы хранятся в самом объекте
+        StaticVector<int, 4> v{ 1, 2, 3 };
+        static_assert(sizeof(v) == 4 * sizeof(int) + sizeof(size_t));
+        assert(v.Size() == 3 && v.Capacity() == 4 && !v.Full());
+        const char* self = reinterpret_cast<const char*>(&v);
+        assert(reinterpret_cast<const char*>(v.begin()) >= self
+               && reinterpret_cast<const char*>(v.end()) <= self + sizeof(v));
+        v.PushBack(4);
+        assert(v.Full());
+        try {
+            v.PushBack(5);
+            assert(false);
+        }
+        catch (const std::length_error&) {
+        }
+        assert(v.Size() == 4 && v[3] == 4);
+        v.Erase(v.begin() + 1);
+        assert(v.Size() == 3 && v[1] == 3 && v[2] == 4);
+        v.Resize(4);
+        assert(v[3] == 0);
+        try {
+            StaticVector<int, 4> too_big(5);
+            assert(false);
+        }
+        catch (const std::length_error&) {
+        }
+    }
+    {
+        Obj::ResetCounters();
+        StaticVector<Obj, 8> a;
+        for (int i = 0; i < 5; ++i) {
+            a.EmplaceBack(i, "static"s);
+        }
+        StaticVector<Obj, 8> b(a);
+        assert(Obj::GetAliveObjectCount() == 10 && b[4].id == 4);
+        b.PopBack();
+        b.PopBack();
+        a.Swap(b);
+        assert(a.Size() == 3 && b.Size() == 5 && b[4].id == 4 && a[2].id == 2);
+        assert(Obj::GetAliveObjectCount() == 8);
+
+        StaticVector<Obj, 8> moved(std::move(b));
+        assert(b.Size() == 0 && moved.Size() == 5 && Obj::GetAliveObjectCount() == 8);
+        a = moved;
+        assert(a.Size() == 5 && a[3].id == 3 && Obj::GetAliveObjectCount() == 10);
+        a = StaticVector<Obj, 8>(2);
+        assert(a.Size() == 2 && a[1].id == 0 && Obj::GetAliveObjectCount() == 7);
+        a.Clear();
+        assert(Obj::GetAliveObjectCount() == 5);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        std::list<std::string> words{ "a"s, "bb"s, "ccc"s };
+        StaticVector<std::string, 3> v(words.begin(), words.end());
+        assert(v.Size() == 3 && v[2] == "ccc"s);
+        assert(v.View().Size() == 3);
+    }
+    {
+        // Диапазон не помещается: уже созданные элементы не должны утечь
+        const std::string long_word(40, 'x');
+        std::list<std::string> words{ long_word, long_word, long_word };
+        try {
+            StaticVector<std::string, 2> v(words.begin(), words.end());
+            assert(false);
+        }
+        catch (const std::length_error&) {
+        }
+        std::istringstream input(long_word + " " + long_word + " " + long_word);
+        try {
+            StaticVector<std::string, 2> v{ std::istream_iterator<std::string>(input), std::istream_iterator<std::string>() };
+            assert(false);
+        }
+        catch (const std::length_error&) {
+        }
+    }
+    {
+        Obj::ResetCounters();
+        std::list<Obj> objects(3);
+        objects.back().throw_on_copy = true;
+        try {
+            StaticVector<Obj, 4> v(objects.begin(), objects.end());
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(Obj::GetAliveObjectCount() == 3);
+    }
+}
+
+template <FlatLayout Layout>
+void CheckFlatMapAgainstStdMap() {
+    FlatMap<int, int, std::less<int>, Layout> flat;
+    std::map<int, int> reference;
+    std::mt19937 random(42);
+    for (int step = 0; step < 3000; ++step) {
+        const int key = static_cast<int>(random() % 500);
+        switch (random() % 4) {
+            case 0:
+                assert(flat.TryEmplace(key, step).second == reference.emplace(key, step).second);
+                break;
+            case 1:
+                assert(flat.Erase(key) == reference.erase(key));
+                break;
+            case 2:
+                flat.InsertOrAssign(key, -step);
+                reference[key] = -step;
+                break;
+            default: {
+                auto it = flat.LowerBound(key);
+                auto expected = reference.lower_bound(key);
+                assert((it == flat.end()) == (expected == reference.end()));
+                if (expected != reference.end()) {
+                    assert(it->first == expected->first && it->second == expected->second);
+                }
+            }
+        }
+    }
+    assert(flat.Size() == reference.size());
+    assert(std::equal(flat.begin(), flat.end(), reference.begin(), [](const auto& lhs, const auto& rhs) {
+        return lhs.first == rhs.first && lhs.second == rhs.second;
+    }));
+    for (int key = -1; key <= 500; ++key) {
+        assert(flat.Contains(key) == (reference.count(key) == 1));
+    }
+}
+
+void Test31() {
+    using namespace std::literals;
+    {
+        FlatMap<std::string, int> routes{ { "b"s, 2 }, { "a"s, 1 }, { "c"s, 3 }, { "a"s, 10 } };
+        assert(routes.Size() == 3);
+        // Из повторяющихся ключей при построении остаётся первый
+        assert(routes.At("a"s) == 1);
+        assert(routes.Keys()[0] == "a"s && routes.Keys()[2] == "c"s);
+        assert(routes.Values()[1] == 2);
+
+        assert(!routes.TryEmplace("b"s, 20).second && routes.At("b"s) == 2);
+        auto [it, inserted] = routes.TryEmplace("bb"s, 22);
+        assert(inserted && it->first == "bb"s && (*it).second == 22 && it - routes.begin() == 2);
+        routes["d"s] += 4;
+        assert(routes.At("d"s) == 4 && routes.Size() == 5);
+        assert(!routes.InsertOrAssign("a"s, 100).second && routes.At("a"s) == 100);
+
+        try {
+            routes.At("zzz"s);
+            assert(false);
+        }
+        catch (const std::out_of_range&) {
+        }
+        assert(routes.Find("zzz"s) == routes.end() && routes.LowerBound("zzz"s) == routes.end());
+        assert(routes.Erase("bb"s) == 1 && routes.Erase("bb"s) == 0 && !routes.Contains("bb"s));
+
+        const auto& const_routes = routes;
+        int sum = 0;
+        for (const auto& [key, value] : const_routes) {
+            sum += value;
+        }
+        assert(sum == 100 + 2 + 3 + 4);
+    }
+    CheckFlatMapAgainstStdMap<FlatLayout::SORTED>();
+    CheckFlatMapAgainstStdMap<FlatLayout::EYTZINGER>();
+    {
+        // Пакетная вставка: одно слияние, существующие значения сохраняются, повторы пропускаются
+        FlatMap<int, std::string, std::less<int>, FlatLayout::EYTZINGER> table{ { 2, "two"s }, { 4, "four"s } };
+        std::vector<std::pair<int, std::string>> batch{ { 1, "one"s }, { 2, "TWO"s }, { 3, "three"s },
+                                                        { 3, "THREE"s }, { 5, "five"s } };
+        table.InsertSorted(batch.begin(), batch.end());
+        assert(table.Size() == 5);
+        assert(table.At(2) == "two"s && table.At(3) == "three"s && table.At(5) == "five"s);
+        for (int key = 0; key <= 6; ++key) {
+            assert(table.Contains(key) == (key >= 1 && key <= 5));
+        }
+
+        std::map<int, std::string> source{ { 0, "zero"s }, { 6, "six"s } };
+        table.InsertSorted(source.begin(), source.end());
+        assert(table.Size() == 7 && table.Find(0)->second == "zero"s && table.LowerBound(6)->second == "six"s);
+    }
+    {
+        // Исключение при копировании пакета оставляет таблицу прежней
+        Obj::ResetCounters();
+        FlatMap<int, Obj> objects;
+        objects.TryEmplace(1, 1);
+        objects.TryEmplace(3, 3);
+        std::vector<std::pair<int, Obj>> batch(3);
+        for (int i = 0; i < 3; ++i) {
+            batch[i].first = 2 * i;
+            batch[i].second.id = 2 * i;
+        }
+        batch[2].second.throw_on_copy = true;
+        try {
+            objects.InsertSorted(batch.begin(), batch.end());
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(objects.Size() == 2 && objects.At(1).id == 1 && objects.At(3).id == 3);
+        batch.pop_back();
+        objects.InsertSorted(std::make_move_iterator(batch.begin()), std::make_move_iterator(batch.end()));
+        assert(objects.Size() == 4 && objects.At(2).id == 2 && objects.Keys()[0] == 0);
+    }
+    {
+        FlatSet<int, std::greater<int>> set{ 5, 1, 4, 1, 3 };
+        assert(set.Size() == 4 && *set.begin() == 5 && set.View()[3] == 1);
+        assert(set.Insert(2).second && !set.Insert(4).second);
+        assert(*set.LowerBound(6) == 5 && set.LowerBound(0) == set.end());
+        assert(set.Erase(5) == 1 && !set.Contains(5) && set.Contains(2));
+
+        FlatSet<int, std::less<int>, FlatLayout::EYTZINGER> sorted;
+        std::vector<int> odd;
+        for (int i = 1; i < 200; i += 2) {
+            odd.push_back(i);
+        }
+        sorted.InsertSorted(odd.begin(), odd.end());
+        sorted.InsertSorted(odd.begin(), odd.begin() + 10);
+        assert(sorted.Size() == 100);
+        for (int i = 0; i <= 200; ++i) {
+            assert(sorted.Contains(i) == (i % 2 == 1));
+            const auto it = sorted.LowerBound(i);
+            assert(it == sorted.end() ? i >= 199 : *it == (i % 2 == 1 ? i : i + 1));
+        }
+        assert(sorted.Emplace(42).second && sorted.Find(42) != sorted.end());
+        sorted.Clear();
+        assert(sorted.Size() == 0 && !sorted.Contains(1));
+    }
+    {
+        // Стандартный поиск по всем длинам и позициям
+        for (size_t n = 0; n <= 33; ++n) {
+            Vector<int> keys(n);
+            for (size_t i = 0; i < n; ++i) {
+                keys[i] = static_cast<int>(2 * i);
+            }
+            for (int key = -1; key <= static_cast<int>(2 * n); ++key) {
+                const size_t expected = std::lower_bound(keys.begin(), keys.end(), key) - keys.begin();
+                assert(flat_detail::BranchlessLowerBound(keys.View().Data(), n, key, std::less<int>()) == expected);
+            }
+        }
+    }
+}
+
+void Test32() {
+    using namespace std::literals;
+    {
+        Obj::ResetCounters();
+        Vector<Obj> config;
+        for (int i = 0; i < 100; ++i) {
+            config.EmplaceBack(i, "config"s);
+        }
+        const Obj* data = config.begin();
+
+        // Снимок забирает буфер, копии снимка его разделяют
+        SharedVector<Obj> snapshot = config.Freeze();
+        assert(config.Size() == 0 && config.Capacity() == 0);
+        assert(snapshot.begin() == data && snapshot.Size() == 100 && snapshot.UseCount() == 1);
+        SharedVector<Obj> reader = snapshot;
+        SharedVector<Obj> another;
+        another = reader;
+        assert(reader.begin() == data && another[99].id == 99 && snapshot.UseCount() == 3);
+        assert(Obj::num_copied == 0 && Obj::GetAliveObjectCount() == 100);
+
+        // Изменение разделённого снимка копирует буфер, остальные копии не меняются
+        reader.Mutable()[0].id = -1;
+        reader.PushBack(Obj(100));
+        assert(reader.begin() != data && reader.Size() == 101 && reader[0].id == -1);
+        assert(snapshot[0].id == 0 && snapshot.UseCount() == 2 && reader.UseCount() == 1);
+        assert(Obj::num_copied == 100);
+
+        // Единственный владелец изменяет буфер на месте
+        const Obj* own = reader.begin();
+        reader.Mutable()[1].id = -2;
+        assert(reader.begin() == own && Obj::num_copied == 100);
+
+        Vector<Obj> thawed = reader.Thaw();
+        assert(thawed.begin() == own && reader.Size() == 0 && reader.UseCount() == 0);
+        Vector<Obj> copied = another.Thaw();
+        assert(copied.begin() != data && copied.Size() == 100 && snapshot.UseCount() == 1);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        SharedVector<int> empty;
+        assert(empty.Size() == 0 && empty.begin() == empty.end() && empty.View().Empty());
+        empty.EmplaceBack(1);
+        assert(empty.Size() == 1 && empty.UseCount() == 1);
+        SharedVector<int> list{ 1, 2, 3 };
+        assert(std::accumulate(list.begin(), list.end(), 0) == 6);
+    }
+    {
+        // Читатели в разных потоках копируют и освобождают снимок, пока владелец его изменяет
+        Vector<int> values(100000);
+        std::iota(values.begin(), values.end(), 0);
+        SharedVector<int> published(std::move(values));
+        const long long expected = 99999LL * 100000 / 2;
+        std::atomic<int> mismatches = 0;
+        Vector<std::thread> readers;
+        for (int t = 0; t < 8; ++t) {
+            readers.EmplaceBack([&mismatches, snapshot = published] {
+                for (int round = 0; round < 20; ++round) {
+                    SharedVector<int> local = snapshot;
+                    if (std::accumulate(local.begin(), local.end(), 0LL) != expected) {
+                        ++mismatches;
+                    }
+                }
+            });
+        }
+        for (int i = 0; i < 100; ++i) {
+            published.Mutable()[i] = 0;
+        }
+        for (std::thread& reader : readers) {
+            reader.join();
+        }
+        assert(mismatches == 0 && published[5] == 0 && published.UseCount() == 1);
+    }
+}
+
+// Количество страниц участка, которым уже выделена физическая память
+size_t ResidentPages(const void* p, size_t bytes) {
+    const uintptr_t begin = reinterpret_cast<uintptr_t>(p) & ~uintptr_t{ 4095 };
+    const size_t length = reinterpret_cast<uintptr_t>(p) + bytes - begin;
+    std::vector<unsigned char> pages((length + 4095) / 4096);
+    if (::mincore(reinterpret_cast<void*>(begin), length, pages.data()) != 0) {
+        return 0;
+    }
+    return static_cast<size_t>(std::count_if(pages.begin(), pages.end(), [](unsigned char page) {
+        return (page & 1) != 0;
+    }));
+}
+
+void Test33() {
+    const size_t MIB = 1024 * 1024;
+    {
+        // Маленькие буферы выделяются как обычно
+        HugePageVector<int> small;
+        small.PushBack(1);
+        small.PushBack(2);
+        assert(small.Size() == 2 && small[1] == 2);
+    }
+    {
+        // Большой буфер - отдельное отображение, выровненное по большой странице
+        HugePageVector<double> v(3 * MIB / sizeof(double));
+        assert(reinterpret_cast<uintptr_t>(v.View().Data()) % HUGE_PAGE_ALIGNMENT == 0);
+        v[v.Size() - 1] = 1.5;
+        // Отображение округлено до 4 МиБ, рост до них идёт на месте
+        const double* data = v.begin();
+        v.Reserve(4 * MIB / sizeof(double));
+        assert(v.begin() == data && v[v.Size() - 1] == 1.5);
+        v.Reserve(4 * MIB / sizeof(double) + 1);
+        assert(v.begin() != data && v[v.Size() - 1] == 1.5);
+
+        Prefault(v);
+        const size_t pages = v.Capacity() * sizeof(double) / 4096;
+        assert(ResidentPages(v.begin(), v.Capacity() * sizeof(double)) >= pages);
+        assert(v[0] == 0.0 && v[v.Size() - 1] == 1.5);
+    }
+    {
+        // Без резерва hugetlbfs буфер получает прозрачные большие страницы
+        HugePageOptions options;
+        options.pages = HugePages::EXPLICIT_2M;
+        options.prefault = true;
+        HugePageVector<char> v{ HugePageAllocator<char>(options) };
+        v.Resize(5 * MIB);
+        assert(v.Size() == 5 * MIB && v[5 * MIB - 1] == 0);
+        assert(ResidentPages(v.begin(), v.Capacity()) >= v.Capacity() / 4096);
+
+        options.fallback = false;
+        try {
+            HugePageVector<char> strict(2 * MIB, HugePageAllocator<char>(options));
+            strict[0] = 1;
+        }
+        catch (const std::bad_alloc&) {
+            // Резерв страниц в vm.nr_hugepages не настроен
+        }
+    }
+    {
+        // Привязка к узлу 0 есть на любой машине. Если ядро не даёт её проверить, узел неизвестен
+        HugePageVector<int> bound(MIB, HugePageAllocator<int>(HugePageOptions::OnNode(0)));
+        bound[0] = 1;
+        const int node = NumaNodeOf(bound.begin());
+        assert(node == 0 || node == -1);
+
+        HugePageVector<int> interleaved(MIB, HugePageAllocator<int>(HugePageOptions::Interleaved()));
+        std::iota(interleaved.begin(), interleaved.end(), 0);
+        assert(interleaved[MIB - 1] == static_cast<int>(MIB - 1));
+
+        // Аллокаторы с разными настройками не равны: буфер не может перейти между ними
+        assert(bound.GetAllocator() != interleaved.GetAllocator());
+        HugePageVector<int> copy(bound);
+        assert(copy.GetAllocator() == bound.GetAllocator() && copy[0] == 1);
+
+        // Присваивание копирует элементы в буфер с настройками lhs
+        HugePageVector<int> small(16, HugePageAllocator<int>(HugePageOptions::Interleaved()));
+        small = bound;
+        assert(small.Size() == MIB && small[0] == 1);
+        assert(small.GetAllocator() == interleaved.GetAllocator());
+    }
+}
+
+#ifdef VECTOR_HARDENED
+// Истина, если f завершает процесс аварийно. f выполняется в дочернем процессе,
+// сообщения проверок и AddressSanitizer не выводятся
+template <typename F>
+bool Dies(F f) {
+    const pid_t pid = ::fork();
+    if (pid == 0) {
+        const int null = ::open("/dev/null", O_WRONLY);
+        ::dup2(null, STDERR_FILENO);
+        f();
+        std::_Exit(0);
+    }
+    int status = 0;
+    ::waitpid(pid, &status, 0);
+    return !(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+#endif
+
+void Test34() {
+    // At проверяет индекс в любой сборке
+    {
+        Vector<int> v{ 1, 2, 3 };
+        const Vector<int>& cv = v;
+        v.At(1) = 20;
+        assert(cv.At(1) == 20 && &cv.At(2) == &v[2]);
+        bool thrown = false;
+        try {
+            (void)cv.At(3);
+        }
+        catch (const std::out_of_range&) {
+            thrown = true;
+        }
+        assert(thrown);
+
+        SmallVector<int, 2> small;
+        for (int i = 1; i <= 3; ++i) {
+            small.PushBack(i);
+        }
+        StaticVector<int, 4> fixed{ 1, 2 };
+        assert(small.At(2) == 3 && fixed.At(1) == 2);
+        thrown = false;
+        try {
+            (void)fixed.At(2);
+        }
+        catch (const std::out_of_range&) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+#ifdef VECTOR_HARDENED
+    // Проверки усиленного режима не зависят от NDEBUG
+    {
+        Vector<int> v{ 1, 2, 3 };
+        assert(!Dies([&] {
+            v[2] = 4;
+        }));
+        assert(Dies([&] {
+            (void)v[3];
+        }));
+        assert(Dies([] {
+            Vector<int> empty;
+            empty.PopBack();
+        }));
+        assert(Dies([] {
+            SmallVector<int, 2> small;
+            small.PushBack(1);
+            (void)small[1];
+        }));
+        assert(Dies([&] {
+            v.Erase(v.end());
+        }));
+        assert(Dies([&] {
+            Vector<int> other{ 1 };
+            v.Insert(other.begin(), 5);
+        }));
+        assert(Dies([] {
+            Vector<int> empty;
+            empty.Reserve(4);
+            RawMemory<int>& memory = *reinterpret_cast<RawMemory<int>*>(&empty);
+            (void)memory[4];
+        }));
+        // Представления проверяются так же, нулевой шаг отклоняется до деления
+        assert(Dies([&] {
+            (void)v.View()[3];
+        }));
+        assert(Dies([&] {
+            (void)StridedView<int>(v.View().Data(), v.Size(), 0);
+        }));
+        // Остальные контейнеры и алгоритмы тоже проверяют границы и длины
+        assert(Dies([] {
+            SoAVector<int, double> soa;
+            soa.EmplaceBack(1, 1.0);
+            (void)soa.Get<0>(1);
+        }));
+        assert(Dies([] {
+            ConcurrentVector<int> concurrent;
+            concurrent.PushBack(1);
+            (void)concurrent[1];
+        }));
+        assert(Dies([] {
+            const Vector<int32_t> a{ 1, 2, 3 };
+            const Vector<int32_t> b{ 1, 2 };
+            (void)simd::Dot(a, b);
+        }));
+        assert(Dies([] {
+            (void)simd::MinMax(VectorView<const int32_t>());
+        }));
+    }
+#endif
+#ifdef VECTOR_DEBUG_ITERATORS
+    // Итератор, переживший замену буфера, обнаруживается при первом обращении
+    {
+        Vector<int> v{ 1, 2, 3 };
+        auto it = v.begin() + 1;
+        Vector<int>::const_iterator cit = it;
+        assert(*it == 2 && cit == v.cbegin() + 1 && v.end() - cit == 2);
+        assert(!Dies([&] {
+            v.Clear();
+            (void)(it == v.begin());
+        }));
+        v.Reserve(v.Capacity() + 1);
+        assert(Dies([&] {
+            (void)*it;
+        }));
+        assert(Dies([&] {
+            v.Erase(cit);
+        }));
+        assert(Dies([&] {
+            (void)(cit < v.cend());
+        }));
+        // Разыменование end() и выход за [begin(), end()]
+        assert(Dies([&] {
+            (void)*v.end();
+        }));
+        assert(Dies([&] {
+            (void)(v.begin() + 4);
+        }));
+        // Итераторы разных векторов несравнимы
+        assert(Dies([&] {
+            Vector<int> other{ 1, 2, 3 };
+            (void)(other.begin() == v.begin());
+        }));
+        // Рост на месте сохраняет адреса, поэтому и итераторы остаются действительными
+        Arena arena;
+        Vector<int, ArenaAllocator<int>> expandable{ ArenaAllocator<int>(arena) };
+        expandable.PushBack(1);
+        auto first = expandable.begin();
+        expandable.Reserve(64);
+        assert(&*first == &expandable[0] && *first == 1);
+    }
+#endif
+#if VECTOR_ANNOTATE_CONTAINER
+    // Неиспользуемый хвост буфера недоступен, и разметка следует за всеми операциями
+    {
+        Vector<int64_t> v;
+        v.Reserve(16);
+        v.PushBack(1);
+        const int64_t* data = v.View().Data();
+        assert(Dies([&] {
+            (void)*static_cast<const volatile int64_t*>(data + 1);
+        }));
+        const auto verify = [](const Vector<int64_t>& vector) {
+            const int64_t* begin = vector.View().Data();
+            return begin == nullptr
+                   || __sanitizer_verify_contiguous_container(begin, begin + vector.Size(), begin + vector.Capacity()) != 0;
+        };
+        const int64_t values[] = { 7, 8, 9 };
+        v.Insert(v.begin(), std::begin(values), std::end(values));
+        assert(verify(v) && v.Size() == 4);
+        v.Resize(10);
+        v.Erase(v.begin() + 2, v.begin() + 6);
+        assert(verify(v) && v.Size() == 6);
+        v.RemoveIf([](int64_t x) {
+            return x == 0;
+        });
+        v.SwapErase(v.begin());
+        v.PopBack();
+        assert(verify(v));
+        v.ShrinkToFit();
+        assert(verify(v) && v.Capacity() == v.Size());
+        Vector<int64_t> other(5);
+        v.Swap(other);
+        assert(verify(v) && verify(other));
+        other = v;
+        v = Vector<int64_t>{ 1, 2 };
+        assert(verify(v) && verify(other));
+        v.Reserve(100);
+        v.Clear();
+        assert(verify(v));
+        assert(Dies([&] {
+            (void)*static_cast<const volatile int64_t*>(v.View().Data());
+        }));
+        // Исключение посреди Resize восстанавливает разметку по прежнему размеру
+        Obj::ResetCounters();
+        {
+            Vector<Obj> objects(2);
+            objects.Reserve(8);
+            Obj::default_construction_throw_countdown = 2;
+            try {
+                objects.Resize(6);
+                assert(false);
+            }
+            catch (const std::runtime_error&) {
+            }
+            assert(objects.Size() == 2);
+            objects.EmplaceBack(1);
+            assert(objects[2].id == 1);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+#endif
+}
+
+void Test35() {
+#ifdef VECTOR_ENABLE_PROFILING
+    struct ProfileProbe {
+        int value = 0;
+    };
+    using ProbeVector = Vector<ProfileProbe>;
+    VectorProfiler& profiler = VectorProfiler::Instance();
+
+    // Обёртки, создающие векторы, передают место своего вызова дальше
+    const VectorSourceLocation site_location{ "profile_test.cpp", "Fill", 10, 0 };
+    const auto fill = [&site_location](size_t count) {
+        ProbeVector v(site_location);
+        for (size_t i = 0; i < count; ++i) {
+            v.PushBack(ProfileProbe{ static_cast<int>(i) });
+        }
+        return v.Capacity();
+    };
+    VectorProfileSite* site = profiler.SiteFor(site_location, sizeof(ProfileProbe));
+    assert(site != nullptr && site == profiler.SiteFor(site_location, sizeof(ProfileProbe)));
+    assert(site != profiler.SiteFor(site_location, sizeof(ProfileProbe) + 1));
+    site->Reset();
+
+    for (size_t i = 0; i < VectorProfileSite::HINT_MIN_SAMPLES; ++i) {
+        assert(fill(100) == 128);
+    }
+    VectorProfileSite::Snapshot snapshot = site->Read();
+    assert(snapshot.vectors == VectorProfileSite::HINT_MIN_SAMPLES);
+    assert(snapshot.destroyed == VectorProfileSite::HINT_MIN_SAMPLES);
+    // Вместимость 1, 2, 4, ..., 128: восемь выделений на вектор
+    assert(snapshot.reallocations == 8 * VectorProfileSite::HINT_MIN_SAMPLES);
+    assert(snapshot.elements_relocated == 127 * VectorProfileSite::HINT_MIN_SAMPLES);
+    assert(snapshot.reallocation_ns > 0);
+    assert(snapshot.max_size == 100 && snapshot.size_histogram[7] == VectorProfileSite::HINT_MIN_SAMPLES);
+    assert(snapshot.capacity_hint == 100);
+
+    // Подсказка не применяется, пока не включена, а после включения первый рост сразу выделяет её
+    assert(fill(100) == 128);
+    profiler.EnableHints(true);
+    const size_t reallocations_before = site->Read().reallocations;
+    assert(fill(100) == 100);
+    assert(fill(150) == 200);
+    assert(site->Read().reallocations == reallocations_before + 1 + 2);
+    {
+        // Подсказка касается только первого выделения пустого вектора
+        ProbeVector reserved(site_location);
+        reserved.Reserve(10);
+        for (int i = 0; i < 11; ++i) {
+            reserved.PushBack(ProfileProbe{ i });
+        }
+        assert(reserved.Capacity() == 20);
+    }
+    profiler.EnableHints(false);
+
+    // Место по умолчанию - строка, где создан вектор; перемещённый вектор не становится выборкой
+    {
+        ProbeVector here;
+        ProbeVector moved(std::move(here));
+        moved.PushBack(ProfileProbe{});
+        ProbeVector copy = moved;
+        (void)copy;
+    }
+    bool found = false;
+    profiler.ForEach([&found](const VectorProfileSite& profile) {
+        if (profile.elem_size == sizeof(ProfileProbe) && profile.location.line != 10
+            && std::string(profile.location.file).find("main.cpp") != std::string::npos) {
+            const VectorProfileSite::Snapshot s = profile.Read();
+            found |= s.vectors == 1 && s.destroyed == 1 && s.max_size == 1;
+        }
+    });
+    assert(found);
+
+    // Одно место из многих потоков
+    const VectorSourceLocation shared_location{ "profile_test.cpp", "Shared", 20, 0 };
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&shared_location] {
+            for (int i = 0; i < 1000; ++i) {
+                ProbeVector v(shared_location);
+                v.PushBack(ProfileProbe{ i });
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    assert(profiler.SiteFor(shared_location, sizeof(ProfileProbe))->Read().vectors == 4000);
+
+    std::ostringstream report;
+    profiler.Dump(report);
+    assert(report.str().find("site=profile_test.cpp:10:0 function=Fill") != std::string::npos);
+    assert(report.str().find("capacity_hint=100 sizes=0,0,0,0,1,0,0,34,1\n") != std::string::npos);
+    // Первыми идут места, дольше всех занятые реаллокациями
+    std::istringstream lines(report.str());
+    unsigned long long previous_ns = std::numeric_limits<unsigned long long>::max();
+    for (std::string line; std::getline(lines, line);) {
+        const unsigned long long ns = std::stoull(line.substr(line.find("reallocation_ns=") + 16));
+        assert(ns <= previous_ns);
+        previous_ns = ns;
     }
+#endif
 }
 
 int main() {
@@ -654,7 +3067,35 @@ int main() {
         Test4();
         Test5();
         Test6();
-        Benchmark();
+        Test7();
+        Test8();
+        Test9();
+        Test10();
+        Test11();
+        Test12();
+        Test13();
+        Test14();
+        Test15();
+        Test16();
+        Test17();
+        Test18();
+        Test19();
+        Test20();
+        Test21();
+        Test22();
+        Test23();
+        Test24();
+        Test25();
+        Test26();
+        Test27();
+        Test28();
+        Test29();
+        Test30();
+        Test31();
+        Test32();
+        Test33();
+        Test34();
+        Test35();
     }
     catch (const std::exception& e) {
         std::cerr << e.what() << std::endl;
@@ -0,0 +1,348 @@
+#pragma once
+
+#include "vector.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Хранение элементов Vector в отображённом в память файле (Linux). Файл открывается как готовый
+// вектор без чтения и копирования элементов: страницы подгружаются ОС по мере обращения, поэтому
+// данные могут быть больше оперативной памяти. Только для тривиально копируемых типов
+
+enum class MapMode {
+    // Изменения попадают в файл
+    SHARED,
+    // Изменения видны только процессу, файл не меняется
+    PRIVATE,
+};
+
+// Файл с данными вектора. Первая страница - заголовок, элементы начинаются со второй страницы,
+// так что смещение отображения выровнено по странице
+class MappedFile {
+public:
+    static constexpr uint64_t MAGIC = 0x3152544345564441;  // "ADVECTR1"
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t DATA_OFFSET = PAGE_ALIGNMENT;
+
+    struct Header {
+        uint64_t magic = MAGIC;
+        uint32_t version = VERSION;
+        uint32_t elem_size = 0;
+        uint64_t size = 0;
+        uint64_t capacity = 0;
+    };
+
+    // Открывает файл, в режиме SHARED создаёт его при отсутствии.
+    // Бросает std::system_error при ошибке ввода-вывода и std::runtime_error при несовпадении формата
+    MappedFile(const std::string& path, MapMode mode, size_t elem_size)
+        : mode_(mode) {
+        fd_ = mode == MapMode::SHARED ? ::open(path.c_str(), O_RDWR | O_CREAT, 0644) : ::open(path.c_str(), O_RDONLY);
+        if (fd_ < 0) {
+            ThrowErrno("open");
+        }
+        try {
+            if (FileSize() == 0 && mode == MapMode::SHARED) {
+                header_.elem_size = static_cast<uint32_t>(elem_size);
+                WriteHeader();
+            }
+            else {
+                if (::pread(fd_, &header_, sizeof(header_), 0) != static_cast<ssize_t>(sizeof(header_))) {
+                    throw std::runtime_error("mapped vector file is truncated");
+                }
+                if (header_.magic != MAGIC || header_.version != VERSION) {
+                    throw std::runtime_error("not a mapped vector file");
+                }
+                if (header_.elem_size != elem_size) {
+                    throw std::runtime_error("mapped vector file has a different element size");
+                }
+            }
+        }
+        catch (...) {
+            ::close(fd_);
+            throw;
+        }
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+        if (data_ != nullptr) {
+            ::munmap(data_, data_bytes_);
+        }
+        ::close(fd_);
+    }
+
+    MapMode Mode() const noexcept {
+        return mode_;
+    }
+
+    // Заголовок в том виде, в каком он был прочитан при открытии или записан последним Sync
+    const Header& GetHeader() const noexcept {
+        return header_;
+    }
+
+    // Адрес отображённых данных или nullptr
+    void* Data() const noexcept {
+        return data_;
+    }
+
+    // Отображает первые bytes байт данных, при необходимости удлиняя файл. В режиме PRIVATE
+    // часть за концом файла - анонимная память: файл не удлиняется, а обращение за границей
+    // файлового отображения привело бы к SIGBUS
+    void* Map(size_t bytes) {
+        assert(data_ == nullptr);
+        void* data = nullptr;
+        if (mode_ == MapMode::SHARED) {
+            EnsureFileSize(DATA_OFFSET + bytes);
+            data = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, DATA_OFFSET);
+        }
+        else {
+            data = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            const size_t file_bytes = std::min(bytes, FileSize() > DATA_OFFSET ? FileSize() - DATA_OFFSET : 0);
+            if (data != MAP_FAILED && file_bytes != 0
+                && ::mmap(data, file_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd_, DATA_OFFSET)
+                       == MAP_FAILED) {
+                ::munmap(data, bytes);
+                data = MAP_FAILED;
+            }
+        }
+        if (data == MAP_FAILED) {
+            ThrowErrno("mmap");
+        }
+        data_ = data;
+        data_bytes_ = bytes;
+        return data;
+    }
+
+    // Меняет длину отображения через mremap, адрес может измениться. Возвращает nullptr, если это
+    // невозможно: в режиме PRIVATE отображение состоит из файловой и анонимной частей
+    void* Remap(size_t new_bytes) noexcept {
+        assert(data_ != nullptr);
+        if (mode_ != MapMode::SHARED) {
+            return nullptr;
+        }
+        try {
+            EnsureFileSize(DATA_OFFSET + new_bytes);
+        }
+        catch (const std::system_error&) {
+            return nullptr;
+        }
+        void* data = ::mremap(data_, data_bytes_, new_bytes, MREMAP_MAYMOVE);
+        if (data == MAP_FAILED) {
+            return nullptr;
+        }
+        data_ = data;
+        data_bytes_ = new_bytes;
+        return data;
+    }
+
+    void Unmap() noexcept {
+        assert(data_ != nullptr);
+        ::munmap(data_, data_bytes_);
+        data_ = nullptr;
+        data_bytes_ = 0;
+    }
+
+    // Сбрасывает изменённые страницы на диск и записывает в заголовок размер и вместимость
+    void Sync(size_t size, size_t capacity) {
+        assert(mode_ == MapMode::SHARED);
+        if (data_ != nullptr && ::msync(data_, data_bytes_, MS_SYNC) != 0) {
+            ThrowErrno("msync");
+        }
+        header_.size = size;
+        header_.capacity = capacity;
+        WriteHeader();
+        if (::fdatasync(fd_) != 0) {
+            ThrowErrno("fdatasync");
+        }
+    }
+
+private:
+    MapMode mode_;
+    int fd_ = -1;
+    Header header_;
+    void* data_ = nullptr;
+    size_t data_bytes_ = 0;
+
+    [[noreturn]] static void ThrowErrno(const char* what) {
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+
+    size_t FileSize() const {
+        struct stat st {};
+        if (::fstat(fd_, &st) != 0) {
+            ThrowErrno("fstat");
+        }
+        return static_cast<size_t>(st.st_size);
+    }
+
+    // Файл только удлиняется: при уменьшении вместимости хвост остаётся до следующего роста
+    void EnsureFileSize(size_t bytes) {
+        if (FileSize() < bytes && ::ftruncate(fd_, static_cast<off_t>(bytes)) != 0) {
+            ThrowErrno("ftruncate");
+        }
+    }
+
+    void WriteHeader() {
+        if (::pwrite(fd_, &header_, sizeof(header_), 0) != static_cast<ssize_t>(sizeof(header_))) {
+            ThrowErrno("pwrite");
+        }
+        EnsureFileSize(DATA_OFFSET);
+    }
+};
+
+// Аллокатор, отдающий под первый буфер отображение файла. Рост идёт через reallocate (mremap)
+// без переноса элементов. Буферы, которые не могут лежать в файле (копии вектора, временные
+// буферы, пока файл уже отображён), выделяются из кучи через malloc
+template <typename T>
+class MappedFileAllocator {
+public:
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    template <typename U>
+    struct rebind {
+        using other = MappedFileAllocator<U>;
+    };
+
+    MappedFileAllocator() noexcept = default;
+
+    explicit MappedFileAllocator(std::shared_ptr<MappedFile> file) noexcept
+        : file_(std::move(file)) {
+    }
+
+    template <typename U>
+    MappedFileAllocator(const MappedFileAllocator<U>& other) noexcept
+        : file_(other.GetFile()) {
+    }
+
+    const std::shared_ptr<MappedFile>& GetFile() const noexcept {
+        return file_;
+    }
+
+    T* allocate(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_alloc();
+        }
+        if (file_ && file_->Data() == nullptr) {
+            return static_cast<T*>(file_->Map(n * sizeof(T)));
+        }
+        if (void* p = std::malloc(n * sizeof(T))) {
+            return static_cast<T*>(p);
+        }
+        throw std::bad_alloc();
+    }
+
+    void deallocate(T* p, size_t /*n*/) noexcept {
+        if (file_ && file_->Data() == p) {
+            file_->Unmap();
+        }
+        else {
+            std::free(static_cast<void*>(p));
+        }
+    }
+
+    T* reallocate(T* p, size_t /*old_n*/, size_t new_n) noexcept {
+        if (new_n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            return nullptr;
+        }
+        if (file_ && file_->Data() == p) {
+            return static_cast<T*>(file_->Remap(new_n * sizeof(T)));
+        }
+        return static_cast<T*>(std::realloc(static_cast<void*>(p), new_n * sizeof(T)));
+    }
+
+    // Копия вектора живёт в куче и не разделяет с оригиналом файл
+    MappedFileAllocator select_on_container_copy_construction() const noexcept {
+        return MappedFileAllocator();
+    }
+
+    template <typename U>
+    bool operator==(const MappedFileAllocator<U>& other) const noexcept {
+        return file_ == other.GetFile();
+    }
+    template <typename U>
+    bool operator!=(const MappedFileAllocator<U>& other) const noexcept {
+        return !(*this == other);
+    }
+
+private:
+    std::shared_ptr<MappedFile> file_;
+};
+
+// Vector, хранящий элементы в файле. При открытии существующего файла элементы доступны сразу:
+// отображается записанная вместимость, а размер берётся из заголовка. В режиме SHARED размер
+// сохраняется в заголовок при Sync и в деструкторе
+template <typename T, typename Growth = DoublingGrowth>
+class MappedVector {
+    static_assert(std::is_trivially_copyable_v<T>, "MappedVector requires a trivially copyable element type");
+
+public:
+    using VectorType = Vector<T, MappedFileAllocator<T>, Growth>;
+
+    explicit MappedVector(const std::string& path, MapMode mode = MapMode::SHARED)
+        : file_(std::make_shared<MappedFile>(path, mode, sizeof(T)))
+        , vector_(MappedFileAllocator<T>(file_)) {
+        const MappedFile::Header& header = file_->GetHeader();
+        if (header.size > header.capacity) {
+            throw std::runtime_error("mapped vector file has a corrupted header");
+        }
+        if (header.capacity != 0) {
+            vector_.Reserve(header.capacity);
+            vector_.ResizeUninitialized(header.size);
+        }
+    }
+
+    MappedVector(const MappedVector&) = delete;
+    MappedVector& operator=(const MappedVector&) = delete;
+
+    ~MappedVector() {
+        if (file_->Mode() == MapMode::SHARED) {
+            try {
+                Sync();
+            }
+            catch (...) {
+                // Деструктор не сообщает об ошибках: для гарантии записи нужно вызвать Sync явно
+            }
+        }
+    }
+
+    VectorType& operator*() noexcept {
+        return vector_;
+    }
+    const VectorType& operator*() const noexcept {
+        return vector_;
+    }
+    VectorType* operator->() noexcept {
+        return &vector_;
+    }
+    const VectorType* operator->() const noexcept {
+        return &vector_;
+    }
+
+    // Записывает данные и размер в файл. Только для режима SHARED
+    void Sync() {
+        if (file_->Mode() != MapMode::SHARED) {
+            throw std::logic_error("private mapping cannot be synced");
+        }
+        if (vector_.Capacity() != 0 && file_->Data() != vector_.begin()) {
+            // Файл не удалось удлинить, и Reserve перенёс элементы в кучу
+            throw std::runtime_error("vector storage is no longer backed by the file");
+        }
+        file_->Sync(vector_.Size(), vector_.Capacity());
+    }
+
+private:
+    std::shared_ptr<MappedFile> file_;
+    VectorType vector_;
+};
@@ -0,0 +1,336 @@
+#pragma once
+
+#include "vector.h"
+
+#include <iterator>
+
+// Вектор из блоков фиксированного размера 2^ChunkShift элементов. Добавление в конец никогда
+// не переносит уже созданные элементы: ссылки, указатели и итераторы на них остаются действительными,
+// а время PushBack не зависит от размера контейнера. Индексация - сдвиг и маска
+template <typename T, size_t ChunkShift = 10, typename Alloc = std::allocator<T>>
+class SegmentedVector {
+    static_assert(ChunkShift < sizeof(size_t) * 8, "chunk size does not fit into size_t");
+
+    using Chunk = RawMemory<T, Alloc>;
+    using AllocTraits = std::allocator_traits<Alloc>;
+
+    template <bool IsConst>
+    class BasicIterator;
+
+public:
+    using iterator = BasicIterator<false>;
+    using const_iterator = BasicIterator<true>;
+    using allocator_type = Alloc;
+
+    static constexpr size_t CHUNK_SIZE = size_t{ 1 } << ChunkShift;
+
+    SegmentedVector() = default;
+
+    explicit SegmentedVector(const Alloc& alloc)
+        : alloc_(alloc) {
+    }
+
+    SegmentedVector(const SegmentedVector& other)
+        : SegmentedVector(other, AllocTraits::select_on_container_copy_construction(other.alloc_)) {
+    }
+
+    SegmentedVector(const SegmentedVector& other, const Alloc& alloc)
+        : alloc_(alloc) {
+        Reserve(other.size_);
+        other.ForEachChunk([this](const T* data, size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                EmplaceBack(data[i]);
+            }
+        });
+    }
+
+    SegmentedVector(SegmentedVector&& other) noexcept
+        : chunks_(std::move(other.chunks_))
+        , size_(exchange(other.size_, 0))
+        , alloc_(other.alloc_) {
+    }
+
+    // Копия строится на аллокаторе, который достанется lhs: на аллокаторе rhs при
+    // propagate_on_container_copy_assignment, иначе на собственном
+    SegmentedVector& operator=(const SegmentedVector& rhs) {
+        if (this != &rhs) {
+            if constexpr (AllocTraits::propagate_on_container_copy_assignment::value) {
+                SegmentedVector rhs_copy(rhs, rhs.alloc_);
+                StealFrom(rhs_copy);
+                alloc_ = rhs.alloc_;
+            }
+            else {
+                SegmentedVector rhs_copy(rhs, alloc_);
+                StealFrom(rhs_copy);
+            }
+        }
+        return *this;
+    }
+
+    SegmentedVector& operator=(SegmentedVector&& rhs) noexcept(AllocTraits::propagate_on_container_move_assignment::value
+                                                               || AllocTraits::is_always_equal::value) {
+        if (this == &rhs) {
+            return *this;
+        }
+        if constexpr (AllocTraits::propagate_on_container_move_assignment::value) {
+            StealFrom(rhs);
+            alloc_ = rhs.alloc_;
+        }
+        else if (AllocTraits::is_always_equal::value || alloc_ == rhs.alloc_) {
+            StealFrom(rhs);
+        }
+        else {
+            // Блоки rhs выделены чужим аллокатором: элементы переносятся поштучно в свои блоки
+            Clear();
+            Reserve(rhs.size_);
+            rhs.ForEachChunk([this](T* data, size_t count) {
+                for (size_t i = 0; i < count; ++i) {
+                    EmplaceBack(std::move(data[i]));
+                }
+            });
+            rhs.Clear();
+        }
+        return *this;
+    }
+
+    ~SegmentedVector() {
+        Clear();
+    }
+
+    iterator begin() noexcept {
+        return iterator(this, 0);
+    }
+    iterator end() noexcept {
+        return iterator(this, size_);
+    }
+    const_iterator begin() const noexcept {
+        return const_iterator(this, 0);
+    }
+    const_iterator end() const noexcept {
+        return const_iterator(this, size_);
+    }
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return chunks_.Size() * CHUNK_SIZE;
+    }
+
+    // Заранее выделяет блоки под capacity элементов
+    void Reserve(size_t capacity) {
+        chunks_.Reserve((capacity + CHUNK_SIZE - 1) >> ChunkShift);
+        while (Capacity() < capacity) {
+            chunks_.EmplaceBack(CHUNK_SIZE, alloc_);
+        }
+    }
+
+    template <typename Type>
+    void PushBack(Type&& value) {
+        EmplaceBack(std::forward<Type>(value));
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        if (size_ == Capacity()) {
+            // Новый блок добавляется до создания элемента, args могут ссылаться на существующие элементы,
+            // которые при этом не перемещаются
+            chunks_.EmplaceBack(CHUNK_SIZE, alloc_);
+        }
+        T* slot = chunks_[size_ >> ChunkShift].GetAddress() + (size_ & MASK);
+        new (slot) T(std::forward<Args>(args)...);
+        ++size_;
+        return *slot;
+    }
+
+    void PopBack() noexcept {
+        VECTOR_CHECK(size_ > 0);
+        std::destroy_at(&(*this)[size_ - 1]);
+        --size_;
+    }
+
+    // Разрушает элементы, сохраняя выделенные блоки
+    void Clear() noexcept {
+        ForEachChunk([](T* data, size_t count) {
+            std::destroy_n(data, count);
+        });
+        size_ = 0;
+    }
+
+    // Без propagate_on_container_swap аллокаторы должны быть равны: каждый вектор продолжает
+    // выделять блоки своим аллокатором
+    void Swap(SegmentedVector& other) noexcept {
+        if constexpr (AllocTraits::propagate_on_container_swap::value) {
+            std::swap(alloc_, other.alloc_);
+        }
+        else {
+            assert(alloc_ == other.alloc_);
+        }
+        chunks_.Swap(other.chunks_);
+        std::swap(size_, other.size_);
+    }
+
+    T& operator[](size_t index) noexcept {
+        VECTOR_CHECK(index < size_);
+        return chunks_[index >> ChunkShift][index & MASK];
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<SegmentedVector&>(*this)[index];
+    }
+
+    // Количество блоков, содержащих элементы
+    size_t ChunkCount() const noexcept {
+        return (size_ + CHUNK_SIZE - 1) >> ChunkShift;
+    }
+
+    // Непрерывный участок элементов блока chunk. Все блоки, кроме последнего, заполнены целиком
+    T* ChunkData(size_t chunk) noexcept {
+        VECTOR_CHECK(chunk < ChunkCount());
+        return chunks_[chunk].GetAddress();
+    }
+
+    const T* ChunkData(size_t chunk) const noexcept {
+        return const_cast<SegmentedVector&>(*this).ChunkData(chunk);
+    }
+
+    size_t ChunkSize(size_t chunk) const noexcept {
+        VECTOR_CHECK(chunk < ChunkCount());
+        return chunk + 1 < ChunkCount() ? CHUNK_SIZE : size_ - (chunk << ChunkShift);
+    }
+
+    // Вызывает f(T* data, size_t count) для каждого непрерывного участка по порядку.
+    // Удобно для обработки элементов пачками без проверки границы блока на каждом элементе
+    template <typename F>
+    void ForEachChunk(F f) {
+        for (size_t chunk = 0, count = ChunkCount(); chunk < count; ++chunk) {
+            f(ChunkData(chunk), ChunkSize(chunk));
+        }
+    }
+
+    template <typename F>
+    void ForEachChunk(F f) const {
+        for (size_t chunk = 0, count = ChunkCount(); chunk < count; ++chunk) {
+            f(ChunkData(chunk), ChunkSize(chunk));
+        }
+    }
+
+private:
+    static constexpr size_t MASK = CHUNK_SIZE - 1;
+
+    // Забирает элементы вместе с блоками, аллокатор не меняется
+    void StealFrom(SegmentedVector& other) noexcept {
+        Clear();
+        chunks_ = std::move(other.chunks_);
+        size_ = exchange(other.size_, 0);
+    }
+
+    Vector<Chunk> chunks_;
+    size_t size_ = 0;
+    [[no_unique_address]] Alloc alloc_;
+};
+
+// Итератор произвольного доступа: хранит индекс, элемент находится через operator[] контейнера
+template <typename T, size_t ChunkShift, typename Alloc>
+template <bool IsConst>
+class SegmentedVector<T, ChunkShift, Alloc>::BasicIterator {
+    using Container = std::conditional_t<IsConst, const SegmentedVector, SegmentedVector>;
+
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<IsConst, const T*, T*>;
+    using reference = std::conditional_t<IsConst, const T&, T&>;
+
+    BasicIterator() = default;
+
+    BasicIterator(Container* container, size_t index) noexcept
+        : container_(container)
+        , index_(index) {
+    }
+
+    // Неконстантный итератор неявно приводится к константному
+    operator BasicIterator<true>() const noexcept {
+        return BasicIterator<true>(container_, index_);
+    }
+
+    reference operator*() const noexcept {
+        return (*container_)[index_];
+    }
+    pointer operator->() const noexcept {
+        return &(*container_)[index_];
+    }
+    reference operator[](difference_type n) const noexcept {
+        return (*container_)[index_ + n];
+    }
+
+    BasicIterator& operator++() noexcept {
+        ++index_;
+        return *this;
+    }
+    BasicIterator operator++(int) noexcept {
+        BasicIterator old = *this;
+        ++index_;
+        return old;
+    }
+    BasicIterator& operator--() noexcept {
+        --index_;
+        return *this;
+    }
+    BasicIterator operator--(int) noexcept {
+        BasicIterator old = *this;
+        --index_;
+        return old;
+    }
+    BasicIterator& operator+=(difference_type n) noexcept {
+        index_ += n;
+        return *this;
+    }
+    BasicIterator& operator-=(difference_type n) noexcept {
+        index_ -= n;
+        return *this;
+    }
+    friend BasicIterator operator+(BasicIterator it, difference_type n) noexcept {
+        return it += n;
+    }
+    friend BasicIterator operator+(difference_type n, BasicIterator it) noexcept {
+        return it += n;
+    }
+    friend BasicIterator operator-(BasicIterator it, difference_type n) noexcept {
+        return it -= n;
+    }
+    friend difference_type operator-(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+        return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+    }
+
+    friend bool operator==(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+        return lhs.index_ == rhs.index_;
+    }
+    friend bool operator!=(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+        return lhs.index_ != rhs.index_;
+    }
+    friend bool operator<(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+        return lhs.index_ < rhs.index_;
+    }
+    friend bool operator>(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+        return lhs.index_ > rhs.index_;
+    }
+    friend bool operator<=(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+        return lhs.index_ <= rhs.index_;
+    }
+    friend bool operator>=(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+        return lhs.index_ >= rhs.index_;
+    }
+
+private:
+    Container* container_ = nullptr;
+    size_t index_ = 0;
+};
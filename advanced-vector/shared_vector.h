@@ -0,0 +1,159 @@
+#pragma once
+
+#include "vector.h"
+
+#include <atomic>
+
+// Неизменяемый снимок Vector с подсчётом ссылок. Копирование снимка - O(1): копии разделяют
+// один буфер. Изменение через Mutable() копирует буфер, только если он разделён с другими снимками
+// (копирование при записи). Разные объекты SharedVector, разделяющие буфер, можно использовать
+// из разных потоков одновременно; один и тот же объект - как обычный Vector, из одного потока
+template <typename T, typename Alloc, typename Growth>
+class SharedVector {
+public:
+    using iterator = const T*;
+    using const_iterator = const T*;
+    using vector_type = Vector<T, Alloc, Growth>;
+
+    SharedVector() = default;
+
+    // Забирает буфер вектора без копирования элементов
+    explicit SharedVector(vector_type&& vector)
+        : block_(new Block(std::move(vector))) {
+    }
+
+    explicit SharedVector(const vector_type& vector)
+        : block_(new Block(vector)) {
+    }
+
+    SharedVector(std::initializer_list<T> init)
+        : SharedVector(vector_type(init)) {
+    }
+
+    SharedVector(const SharedVector& other) noexcept
+        : block_(other.block_) {
+        if (block_ != nullptr) {
+            block_->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    SharedVector(SharedVector&& other) noexcept
+        : block_(exchange(other.block_, nullptr)) {
+    }
+
+    SharedVector& operator=(const SharedVector& rhs) noexcept {
+        SharedVector copy(rhs);
+        Swap(copy);
+        return *this;
+    }
+
+    SharedVector& operator=(SharedVector&& rhs) noexcept {
+        SharedVector moved(std::move(rhs));
+        Swap(moved);
+        return *this;
+    }
+
+    ~SharedVector() {
+        Unref(block_);
+    }
+
+    const_iterator begin() const noexcept {
+        return block_ != nullptr ? block_->vector.View().Data() : nullptr;
+    }
+    const_iterator end() const noexcept {
+        return block_ != nullptr ? block_->vector.View().end() : nullptr;
+    }
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    size_t Size() const noexcept {
+        return block_ != nullptr ? block_->vector.Size() : 0;
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        VECTOR_CHECK(index < Size());
+        return block_->vector[index];
+    }
+
+    VectorView<const T> View() const noexcept {
+        return VectorView<const T>(begin(), Size());
+    }
+
+    operator VectorView<const T>() const noexcept {
+        return View();
+    }
+
+    // Количество снимков, разделяющих буфер. При одновременном копировании в других потоках - приблизительно
+    size_t UseCount() const noexcept {
+        return block_ != nullptr ? block_->refs.load(std::memory_order_relaxed) : 0;
+    }
+
+    // Вектор для изменения. Если буфер разделён, сначала создаётся собственная копия.
+    // Ссылка и итераторы действительны до следующего копирования этого снимка: копия снова разделит буфер
+    vector_type& Mutable() {
+        if (block_ == nullptr) {
+            block_ = new Block(vector_type());
+        }
+        else if (block_->refs.load(std::memory_order_acquire) != 1) {
+            // acquire: записи потоков, отпустивших свои ссылки, видны до изменения
+            Block* copy = new Block(std::as_const(block_->vector));
+            Unref(exchange(block_, copy));
+        }
+        return block_->vector;
+    }
+
+    template <typename Type>
+    void PushBack(Type&& value) {
+        Mutable().PushBack(std::forward<Type>(value));
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        return Mutable().EmplaceBack(std::forward<Args>(args)...);
+    }
+
+    // Возвращает содержимое как обычный Vector и оставляет снимок пустым.
+    // Буфер забирается без копирования, если снимок - его единственный владелец
+    vector_type Thaw() {
+        if (block_ == nullptr) {
+            return vector_type();
+        }
+        vector_type result = block_->refs.load(std::memory_order_acquire) == 1 ? std::move(block_->vector)
+                                                                               : vector_type(block_->vector);
+        Unref(exchange(block_, nullptr));
+        return result;
+    }
+
+    void Swap(SharedVector& other) noexcept {
+        std::swap(block_, other.block_);
+    }
+
+private:
+    struct Block {
+        template <typename V>
+        explicit Block(V&& vector)
+            : vector(std::forward<V>(vector)) {
+        }
+
+        std::atomic<size_t> refs{ 1 };
+        vector_type vector;
+    };
+
+    Block* block_ = nullptr;
+
+    // acq_rel: последний владелец видит все записи остальных до разрушения элементов
+    static void Unref(Block* block) noexcept {
+        if (block != nullptr && block->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete block;
+        }
+    }
+};
+
+template <typename T, typename Alloc, typename Growth>
+SharedVector<T, Alloc, Growth> Vector<T, Alloc, Growth>::Freeze() {
+    return SharedVector<T, Alloc, Growth>(std::move(*this));
+}
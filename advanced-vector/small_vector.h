@@ -0,0 +1,337 @@
+#pragma once
+
+#include "vector.h"
+
+// Вектор, хранящий до N элементов прямо в объекте. Куча задействуется, только когда элементов
+// становится больше N. Интерфейс совпадает с Vector, но итераторы и ссылки инвалидируются
+// также при перемещении и обмене, пока элементы хранятся во встроенном буфере
+template <typename T, size_t N, typename Alloc = std::allocator<T>, typename Growth = DoublingGrowth>
+class SmallVector {
+    static_assert(N > 0, "use Vector for containers without inline storage");
+
+    using AllocTraits = std::allocator_traits<Alloc>;
+
+public:
+    using iterator = T*;
+    using const_iterator = const T*;
+    using allocator_type = Alloc;
+    using growth_policy = Growth;
+
+    static constexpr size_t INLINE_CAPACITY = N;
+
+    SmallVector() = default;
+
+    explicit SmallVector(const Alloc& alloc) noexcept
+        : heap_(alloc) {
+    }
+
+    explicit SmallVector(size_t size, const Alloc& alloc = Alloc())
+        : heap_(alloc) {
+        Reserve(size);
+        uninitialized_value_construct_n(begin(), size);
+        size_ = size;
+    }
+
+    SmallVector(const SmallVector& other)
+        : heap_(AllocTraits::select_on_container_copy_construction(other.GetAllocator())) {
+        Reserve(other.size_);
+        uninitialized_copy_n(other.begin(), other.size_, begin());
+        size_ = other.size_;
+    }
+
+    SmallVector(const SmallVector& other, const Alloc& alloc)
+        : heap_(alloc) {
+        Reserve(other.size_);
+        uninitialized_copy_n(other.begin(), other.size_, begin());
+        size_ = other.size_;
+    }
+
+    // Буфер в куче забирается целиком, элементы из встроенного буфера переносятся по одному
+    SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+        : heap_(other.GetAllocator()) {
+        if (other.IsInline()) {
+            std::uninitialized_move_n(other.begin(), other.size_, begin());
+            std::destroy_n(other.begin(), other.size_);
+        }
+        else {
+            heap_ = std::move(other.heap_);
+        }
+        size_ = exchange(other.size_, 0);
+    }
+
+    ~SmallVector() {
+        std::destroy_n(begin(), size_);
+    }
+
+    iterator begin() noexcept {
+        return IsInline() ? InlineData() : heap_.GetAddress();
+    }
+    iterator end() noexcept {
+        return begin() + size_;
+    }
+    const_iterator begin() const noexcept {
+        return const_cast<SmallVector&>(*this).begin();
+    }
+    const_iterator end() const noexcept {
+        return begin() + size_;
+    }
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return IsInline() ? N : heap_.Capacity();
+    }
+
+    // Элементы хранятся во встроенном буфере и не занимают памяти в куче
+    bool IsInline() const noexcept {
+        return heap_.GetAddress() == nullptr;
+    }
+
+    Alloc GetAllocator() const noexcept {
+        return heap_.GetAllocator();
+    }
+
+    void Reserve(size_t new_capacity) {
+        if (new_capacity <= Capacity()) {
+            return;
+        }
+        if (heap_.TryExpand(new_capacity) || heap_.TryReallocate(new_capacity)) {
+            return;
+        }
+        RawMemory<T, Alloc> new_data(new_capacity, heap_.GetAllocator());
+        RelocateN(begin(), size_, new_data.GetAddress());
+        heap_.Swap(new_data);
+    }
+
+    // Если хотя бы один из векторов хранит элементы во встроенном буфере, обмен идёт через
+    // перемещение, которое при неравных аллокаторах может выделять память
+    void Swap(SmallVector& other) noexcept(NOTHROW_MOVE_ASSIGNMENT) {
+        if (!IsInline() && !other.IsInline()) {
+            if constexpr (!AllocTraits::propagate_on_container_swap::value) {
+                assert(GetAllocator() == other.GetAllocator());
+            }
+            heap_.Swap(other.heap_);
+            swap(size_, other.size_);
+        }
+        else {
+            SmallVector tmp(std::move(other));
+            other = std::move(*this);
+            *this = std::move(tmp);
+        }
+    }
+
+    void Resize(size_t new_size) {
+        if (new_size < size_) {
+            std::destroy_n(begin() + new_size, size_ - new_size);
+        }
+        else {
+            Reserve(new_size);
+            uninitialized_value_construct_n(begin() + size_, new_size - size_);
+        }
+        size_ = new_size;
+    }
+
+    void PopBack() {
+        VECTOR_CHECK(size_ > 0);
+        std::destroy_at(begin() + size_ - 1);
+        --size_;
+    }
+
+    iterator Insert(const_iterator pos, const T& value) {
+        return Emplace(pos, value);
+    }
+    iterator Insert(const_iterator pos, T&& value) {
+        return Emplace(pos, move(value));
+    }
+
+    iterator Erase(const_iterator pos) {
+        const size_t position = pos - begin();
+
+        std::move(begin() + position + 1, end(), begin() + position);
+        std::destroy_at(end() - 1);
+        size_ -= 1;
+
+        return begin() + position;
+    }
+
+    template <typename Type>
+    void PushBack(Type&& value) {
+        EmplaceBack(std::forward<Type>(value));
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        if (Capacity() <= size_ && !heap_.TryExpand(NextCapacity(size_ + 1))) {
+            ReallocateAndEmplace(NextCapacity(size_ + 1), size_, std::forward<Args>(args)...);
+        }
+        else {
+            new (end()) T(std::forward<Args>(args)...);
+        }
+        return begin()[size_++];
+    }
+
+    template <typename... Args>
+    iterator Emplace(const_iterator pos, Args&&... args) {
+        const size_t position = pos - begin();
+
+        if (Capacity() <= size_ && !heap_.TryExpand(NextCapacity(size_ + 1))) {
+            ReallocateAndEmplace(NextCapacity(size_ + 1), position, std::forward<Args>(args)...);
+        }
+        else if (position == size_) {
+            new (end()) T(std::forward<Args>(args)...);
+        }
+        else {
+            // Аргументы могут ссылаться на сдвигаемые элементы, поэтому значение создаётся заранее
+            T value(std::forward<Args>(args)...);
+            new (end()) T(std::move(begin()[size_ - 1]));
+            ++size_;
+            std::move_backward(begin() + position, end() - 2, end() - 1);
+            begin()[position] = std::move(value);
+            return begin() + position;
+        }
+        ++size_;
+        return begin() + position;
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<SmallVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        VECTOR_CHECK(index < size_);
+        return begin()[index];
+    }
+
+    // Доступ с проверкой индекса в любой сборке: за пределами вектора - исключение std::out_of_range
+    const T& At(size_t index) const {
+        return const_cast<SmallVector&>(*this).At(index);
+    }
+
+    T& At(size_t index) {
+        if (index >= size_) {
+            throw std::out_of_range("SmallVector index out of range");
+        }
+        return begin()[index];
+    }
+
+    SmallVector& operator=(const SmallVector& rhs) {
+        if (this == &rhs) {
+            return *this;
+        }
+        if constexpr (AllocTraits::propagate_on_container_copy_assignment::value) {
+            if (GetAllocator() != rhs.GetAllocator()) {
+                // Буфер в куче должен освободить тот аллокатор, который его выделил
+                std::destroy_n(begin(), size_);
+                size_ = 0;
+                heap_ = RawMemory<T, Alloc>(rhs.GetAllocator());
+            }
+        }
+        if (rhs.size_ > Capacity()) {
+            // Копия строится на нашем аллокаторе, чтобы Swap не обменивал буферы разных аллокаторов
+            SmallVector rhs_copy(rhs, GetAllocator());
+            Swap(rhs_copy);
+        }
+        else if (size_ <= rhs.size_) {
+            std::copy(rhs.begin(), rhs.begin() + size_, begin());
+            std::uninitialized_copy_n(rhs.begin() + size_, rhs.size_ - size_, end());
+            size_ = rhs.size_;
+        }
+        else {
+            std::copy(rhs.begin(), rhs.end(), begin());
+            std::destroy_n(begin() + rhs.size_, size_ - rhs.size_);
+            size_ = rhs.size_;
+        }
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&& rhs) noexcept(NOTHROW_MOVE_ASSIGNMENT) {
+        if (this == &rhs) {
+            return *this;
+        }
+        if (!rhs.IsInline() && (AllocTraits::propagate_on_container_move_assignment::value
+                                || GetAllocator() == rhs.GetAllocator())) {
+            std::destroy_n(begin(), size_);
+            heap_ = std::move(rhs.heap_);
+            size_ = exchange(rhs.size_, 0);
+            return *this;
+        }
+        // Элементы rhs нельзя забрать вместе с буфером: переносим их по одному в собственную память
+        const size_t common = std::min(size_, rhs.size_);
+        if (rhs.size_ > Capacity()) {
+            std::destroy_n(begin(), size_);
+            size_ = 0;
+            Reserve(rhs.size_);
+            std::uninitialized_move_n(rhs.begin(), rhs.size_, begin());
+        }
+        else {
+            std::move(rhs.begin(), rhs.begin() + common, begin());
+            std::uninitialized_move_n(rhs.begin() + common, rhs.size_ - common, begin() + common);
+            std::destroy_n(begin() + rhs.size_, size_ - common);
+        }
+        size_ = rhs.size_;
+        std::destroy_n(rhs.begin(), rhs.size_);
+        rhs.size_ = 0;
+        return *this;
+    }
+
+private:
+    // Без распространения аллокатора перемещение из кучи с чужим аллокатором
+    // переносит элементы в собственную память и может бросить bad_alloc
+    static constexpr bool NOTHROW_MOVE_ASSIGNMENT =
+        std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_assignable_v<T>
+        && (AllocTraits::propagate_on_container_move_assignment::value || AllocTraits::is_always_equal::value);
+
+    RawMemory<T, Alloc> heap_;
+    size_t size_ = 0;
+    alignas(T) unsigned char inline_[N * sizeof(T)];
+
+    T* InlineData() noexcept {
+        return reinterpret_cast<T*>(inline_);
+    }
+
+    size_t NextCapacity(size_t required) const noexcept {
+        return Growth::NextCapacity(Capacity(), required, sizeof(T));
+    }
+
+    // Перемещает элементы в кучу, оставляя свободной ячейку position, и создаёт в ней элемент из args.
+    // Новый элемент конструируется до переноса старых, так как args могут ссылаться на них
+    template <typename... Args>
+    void ReallocateAndEmplace(size_t new_capacity, size_t position, Args&&... args) {
+        RawMemory<T, Alloc> new_data(new_capacity, heap_.GetAllocator());
+        T* new_elem = new_data.GetAddress() + position;
+
+        new (new_elem) T(std::forward<Args>(args)...);
+
+        if constexpr (IsTriviallyRelocatableV<T>) {
+            RelocateN(begin(), position, new_data.GetAddress());
+            RelocateN(begin() + position, size_ - position, new_elem + 1);
+        }
+        else {
+            try {
+                UninitializedMoveOrCopyN(begin(), position, new_data.GetAddress());
+                try {
+                    UninitializedMoveOrCopyN(begin() + position, size_ - position, new_elem + 1);
+                }
+                catch (...) {
+                    std::destroy_n(new_data.GetAddress(), position);
+                    throw;
+                }
+            }
+            catch (...) {
+                std::destroy_at(new_elem);
+                throw;
+            }
+            std::destroy_n(begin(), size_);
+        }
+
+        heap_.Swap(new_data);
+    }
+};
@@ -0,0 +1,344 @@
+#pragma once
+
+#include "vector.h"
+
+#include <tuple>
+
+// Вектор записей, хранящий каждое поле в отдельной колонке RawMemory (structure of arrays).
+// Колонки имеют общие размер и вместимость и растут вместе. Просмотр одного поля читает только
+// его колонку, а Column<I>() отдаёт её как непрерывный VectorView, пригодный для векторных алгоритмов.
+//
+// Строка - кортеж ссылок на поля. Итератор строк - прокси: operator* возвращает такой кортеж
+// по значению, поэтому итератор не удовлетворяет требованиям прямого итератора стандартной библиотеки,
+// но годится для range-for и структурного связывания
+template <typename... Fields>
+class SoAVector {
+    static_assert(sizeof...(Fields) > 0, "SoAVector needs at least one field");
+
+    using Columns = std::tuple<RawMemory<Fields>...>;
+
+    template <bool IsConst>
+    class BasicIterator;
+
+public:
+    template <size_t I>
+    using FieldType = std::tuple_element_t<I, std::tuple<Fields...>>;
+
+    using Row = std::tuple<Fields&...>;
+    using ConstRow = std::tuple<const Fields&...>;
+    using iterator = BasicIterator<false>;
+    using const_iterator = BasicIterator<true>;
+
+    static constexpr size_t COLUMNS = sizeof...(Fields);
+    // Размер строки во всех колонках, используется политикой роста
+    static constexpr size_t ROW_SIZE = (sizeof(Fields) + ...);
+
+    SoAVector() = default;
+
+    SoAVector(const SoAVector& other)
+        : columns_(MakeColumns(other.size_)) {
+        Transactional(
+            [&](auto i) {
+                UninitializedCopyN(std::get<i>(other.columns_).GetAddress(), other.size_,
+                                   std::get<i>(columns_).GetAddress());
+            },
+            [&](auto i) {
+                std::destroy_n(std::get<i>(columns_).GetAddress(), other.size_);
+            });
+        size_ = other.size_;
+    }
+
+    SoAVector(SoAVector&& other) noexcept
+        : columns_(std::move(other.columns_))
+        , size_(exchange(other.size_, 0)) {
+    }
+
+    SoAVector& operator=(const SoAVector& rhs) {
+        if (this != &rhs) {
+            SoAVector rhs_copy(rhs);
+            Swap(rhs_copy);
+        }
+        return *this;
+    }
+
+    SoAVector& operator=(SoAVector&& rhs) noexcept {
+        Swap(rhs);
+        return *this;
+    }
+
+    ~SoAVector() {
+        Clear();
+    }
+
+    iterator begin() noexcept {
+        return iterator(this, 0);
+    }
+    iterator end() noexcept {
+        return iterator(this, size_);
+    }
+    const_iterator begin() const noexcept {
+        return const_iterator(this, 0);
+    }
+    const_iterator end() const noexcept {
+        return const_iterator(this, size_);
+    }
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return std::get<0>(columns_).Capacity();
+    }
+
+    // Колонка поля I как непрерывный участок
+    template <size_t I>
+    VectorView<FieldType<I>> Column() noexcept {
+        return VectorView<FieldType<I>>(std::get<I>(columns_).GetAddress(), size_);
+    }
+
+    template <size_t I>
+    VectorView<const FieldType<I>> Column() const noexcept {
+        return VectorView<const FieldType<I>>(std::get<I>(columns_).GetAddress(), size_);
+    }
+
+    template <size_t I>
+    FieldType<I>& Get(size_t index) noexcept {
+        VECTOR_CHECK(index < size_);
+        return std::get<I>(columns_)[index];
+    }
+
+    template <size_t I>
+    const FieldType<I>& Get(size_t index) const noexcept {
+        return const_cast<SoAVector&>(*this).template Get<I>(index);
+    }
+
+    Row operator[](size_t index) noexcept {
+        VECTOR_CHECK(index < size_);
+        return MakeRow<Row>(*this, index, std::index_sequence_for<Fields...>{});
+    }
+
+    ConstRow operator[](size_t index) const noexcept {
+        VECTOR_CHECK(index < size_);
+        return MakeRow<ConstRow>(*this, index, std::index_sequence_for<Fields...>{});
+    }
+
+    // Все колонки переносятся в новые буферы. Колонки, копирование которых может выбросить
+    // исключение, переносятся первыми, так что при ошибке вектор остаётся прежним
+    void Reserve(size_t new_capacity) {
+        if (new_capacity <= Capacity()) {
+            return;
+        }
+        Columns new_columns = MakeColumns(new_capacity);
+        RelocateInto(new_columns);
+        SwapColumns(new_columns);
+    }
+
+    // Добавляет строку, поле I конструируется из args[I]
+    template <typename... Args>
+    Row EmplaceBack(Args&&... args) {
+        static_assert(sizeof...(Args) == COLUMNS, "EmplaceBack takes one argument per field");
+        if (size_ == Capacity()) {
+            ReallocateAndEmplace(DoublingGrowth::NextCapacity(Capacity(), size_ + 1, ROW_SIZE),
+                                 std::forward<Args>(args)...);
+        }
+        else {
+            ConstructRow(columns_, size_, std::forward<Args>(args)...);
+        }
+        ++size_;
+        return (*this)[size_ - 1];
+    }
+
+    void PopBack() noexcept {
+        VECTOR_CHECK(size_ > 0);
+        ForEachColumn([this](auto i) {
+            std::destroy_at(std::get<i>(columns_).GetAddress() + size_ - 1);
+        });
+        --size_;
+    }
+
+    // Разрушает все строки, сохраняя вместимость
+    void Clear() noexcept {
+        ForEachColumn([this](auto i) {
+            std::destroy_n(std::get<i>(columns_).GetAddress(), size_);
+        });
+        size_ = 0;
+    }
+
+    void Swap(SoAVector& other) noexcept {
+        SwapColumns(other.columns_);
+        std::swap(size_, other.size_);
+    }
+
+private:
+    Columns columns_;
+    size_t size_ = 0;
+
+    // Перенос колонки типа T не выбрасывает исключений
+    template <typename T>
+    static constexpr bool NOTHROW_RELOCATE = IsTriviallyRelocatableV<T> || std::is_nothrow_move_constructible_v<T>
+                                             || !std::is_copy_constructible_v<T>;
+
+    static Columns MakeColumns(size_t capacity) {
+        return Columns(RawMemory<Fields>(capacity)...);
+    }
+
+    template <typename RowType, typename Self, size_t... I>
+    static RowType MakeRow(Self& self, size_t index, std::index_sequence<I...>) noexcept {
+        return RowType(std::get<I>(self.columns_)[index]...);
+    }
+
+    template <typename F>
+    static void ForEachColumn(F f) {
+        ForEachColumnImpl(f, std::index_sequence_for<Fields...>{});
+    }
+
+    template <typename F, size_t... I>
+    static void ForEachColumnImpl(F& f, std::index_sequence<I...>) {
+        (f(std::integral_constant<size_t, I>{}), ...);
+    }
+
+    // Вызывает f(i) для колонок по порядку. Если f выбросила исключение на колонке k,
+    // для колонок k-1, ..., 0 вызывается undo(i) и исключение пробрасывается дальше
+    template <size_t I = 0, typename F, typename Undo>
+    static void Transactional(F&& f, Undo&& undo) {
+        if constexpr (I < COLUMNS) {
+            f(std::integral_constant<size_t, I>{});
+            try {
+                Transactional<I + 1>(f, undo);
+            }
+            catch (...) {
+                undo(std::integral_constant<size_t, I>{});
+                throw;
+            }
+        }
+    }
+
+    void SwapColumns(Columns& other) noexcept {
+        ForEachColumn([&](auto i) {
+            std::get<i>(columns_).Swap(std::get<i>(other));
+        });
+    }
+
+    // Конструирует строку index в колонках columns. Аргументы могут ссылаться на элементы этого
+    // вектора, поэтому при росте строка создаётся в новых колонках до переноса старых
+    template <typename... Args>
+    static void ConstructRow(Columns& columns, size_t index, Args&&... args) {
+        auto values = std::forward_as_tuple(std::forward<Args>(args)...);
+        Transactional(
+            [&](auto i) {
+                new (std::get<i>(columns).GetAddress() + index)
+                    FieldType<i>(std::get<i>(std::move(values)));
+            },
+            [&](auto i) {
+                std::destroy_at(std::get<i>(columns).GetAddress() + index);
+            });
+    }
+
+    template <typename... Args>
+    void ReallocateAndEmplace(size_t new_capacity, Args&&... args) {
+        Columns new_columns = MakeColumns(new_capacity);
+        ConstructRow(new_columns, size_, std::forward<Args>(args)...);
+        try {
+            RelocateInto(new_columns);
+        }
+        catch (...) {
+            ForEachColumn([&](auto i) {
+                std::destroy_at(std::get<i>(new_columns).GetAddress() + size_);
+            });
+            throw;
+        }
+        SwapColumns(new_columns);
+    }
+
+    // Переносит строки в пустые колонки dst. Сначала копируются колонки, копирование которых
+    // может выбросить исключение (при ошибке копии разрушаются, исходные колонки не тронуты),
+    // затем без исключений переносятся остальные
+    void RelocateInto(Columns& dst) {
+        Transactional(
+            [&](auto i) {
+                if constexpr (!NOTHROW_RELOCATE<FieldType<i>>) {
+                    UninitializedMoveOrCopyN(std::get<i>(columns_).GetAddress(), size_, std::get<i>(dst).GetAddress());
+                }
+            },
+            [&](auto i) {
+                if constexpr (!NOTHROW_RELOCATE<FieldType<i>>) {
+                    std::destroy_n(std::get<i>(dst).GetAddress(), size_);
+                }
+            });
+        ForEachColumn([&](auto i) {
+            if constexpr (NOTHROW_RELOCATE<FieldType<i>>) {
+                RelocateN(std::get<i>(columns_).GetAddress(), size_, std::get<i>(dst).GetAddress());
+            }
+            else {
+                std::destroy_n(std::get<i>(columns_).GetAddress(), size_);
+            }
+        });
+    }
+};
+
+// Итератор строк. Хранит индекс и возвращает строку как кортеж ссылок
+template <typename... Fields>
+template <bool IsConst>
+class SoAVector<Fields...>::BasicIterator {
+    using Container = std::conditional_t<IsConst, const SoAVector, SoAVector>;
+
+public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = std::tuple<Fields...>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = std::conditional_t<IsConst, ConstRow, Row>;
+
+    BasicIterator() = default;
+
+    BasicIterator(Container* container, size_t index) noexcept
+        : container_(container)
+        , index_(index) {
+    }
+
+    reference operator*() const noexcept {
+        return (*container_)[index_];
+    }
+
+    BasicIterator& operator++() noexcept {
+        ++index_;
+        return *this;
+    }
+    BasicIterator operator++(int) noexcept {
+        BasicIterator old = *this;
+        ++index_;
+        return old;
+    }
+    BasicIterator& operator--() noexcept {
+        --index_;
+        return *this;
+    }
+    BasicIterator& operator+=(difference_type n) noexcept {
+        index_ += n;
+        return *this;
+    }
+    friend BasicIterator operator+(BasicIterator it, difference_type n) noexcept {
+        return it += n;
+    }
+    friend difference_type operator-(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+        return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+    }
+
+    friend bool operator==(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+        return lhs.index_ == rhs.index_;
+    }
+    friend bool operator!=(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+        return lhs.index_ != rhs.index_;
+    }
+
+private:
+    Container* container_ = nullptr;
+    size_t index_ = 0;
+};
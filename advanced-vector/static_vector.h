@@ -0,0 +1,267 @@
+#pragma once
+
+#include "vector.h"
+
+#include <stdexcept>
+
+namespace static_vector_detail {
+
+    // Элементы тривиальных типов хранятся в обычном массиве. Константное выражение не может
+    // содержать неинициализированных значений, поэтому при вычислении во время компиляции
+    // массив заполняется значениями по умолчанию, а во время выполнения остаётся нетронутым
+    template <typename T, size_t N,
+              bool = std::is_trivially_default_constructible_v<T> && std::is_trivially_destructible_v<T>>
+    struct Storage {
+        VECTOR_CONSTEXPR Storage() noexcept {
+            if (IsConstantEvaluated()) {
+                for (T& elem : elements) {
+                    ConstructAt(&elem);
+                }
+            }
+        }
+
+        VECTOR_CONSTEXPR T* Data() noexcept {
+            return elements;
+        }
+
+        T elements[N];
+    };
+
+    // Остальные типы - в объединении, чтобы элементы не конструировались и не разрушались вместе с ним
+    template <typename T, size_t N>
+    struct Storage<T, N, false> {
+        Storage() noexcept {
+        }
+        ~Storage() {
+        }
+
+        T* Data() noexcept {
+            return elements;
+        }
+
+        union {
+            T elements[N];
+        };
+    };
+
+}  // namespace static_vector_detail
+
+// Вектор с фиксированной вместимостью N, хранящий элементы прямо в объекте и никогда
+// не обращающийся к куче. Превышение вместимости - исключение std::length_error.
+// В C++20 вектор тривиальных элементов можно построить во время компиляции и сохранить
+// в constexpr-переменной, например, как таблицу поиска
+template <typename T, size_t N>
+class StaticVector {
+    static_assert(N > 0, "StaticVector needs a non-zero capacity");
+
+public:
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    static constexpr size_t CAPACITY = N;
+
+    StaticVector() = default;
+
+    VECTOR_CONSTEXPR explicit StaticVector(size_t size) {
+        CheckCapacity(size);
+        UninitializedValueConstructN(begin(), size);
+        size_ = size;
+    }
+
+    template <typename It, typename = std::enable_if_t<IsIterator<It>::value>>
+    VECTOR_CONSTEXPR StaticVector(It first, It last) {
+        if constexpr (std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<It>::iterator_category>) {
+            const size_t count = static_cast<size_t>(std::distance(first, last));
+            CheckCapacity(count);
+            UninitializedCopyN(first, count, begin());
+            size_ = count;
+        }
+        else {
+            // Деструктор недостроенного объекта не вызывается: созданные элементы разрушаем сами
+            try {
+                for (; first != last; ++first) {
+                    EmplaceBack(*first);
+                }
+            }
+            catch (...) {
+                Clear();
+                throw;
+            }
+        }
+    }
+
+    VECTOR_CONSTEXPR StaticVector(std::initializer_list<T> init) {
+        CheckCapacity(init.size());
+        UninitializedCopyN(init.begin(), init.size(), begin());
+        size_ = init.size();
+    }
+
+    VECTOR_CONSTEXPR StaticVector(const StaticVector& other) {
+        UninitializedCopyN(other.begin(), other.size_, begin());
+        size_ = other.size_;
+    }
+
+    // Элементы перемещаются по одному, other становится пустым
+    VECTOR_CONSTEXPR StaticVector(StaticVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        UninitializedCopyN(std::make_move_iterator(other.begin()), other.size_, begin());
+        size_ = other.size_;
+        other.Clear();
+    }
+
+    VECTOR_CONSTEXPR ~StaticVector() {
+        std::destroy_n(begin(), size_);
+    }
+
+    VECTOR_CONSTEXPR iterator begin() noexcept {
+        return storage_.Data();
+    }
+    VECTOR_CONSTEXPR iterator end() noexcept {
+        return begin() + size_;
+    }
+    VECTOR_CONSTEXPR const_iterator begin() const noexcept {
+        return const_cast<StaticVector&>(*this).begin();
+    }
+    VECTOR_CONSTEXPR const_iterator end() const noexcept {
+        return begin() + size_;
+    }
+    VECTOR_CONSTEXPR const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    VECTOR_CONSTEXPR const_iterator cend() const noexcept {
+        return end();
+    }
+
+    VECTOR_CONSTEXPR size_t Size() const noexcept {
+        return size_;
+    }
+
+    VECTOR_CONSTEXPR size_t Capacity() const noexcept {
+        return N;
+    }
+
+    // Следующая вставка выбросит исключение
+    VECTOR_CONSTEXPR bool Full() const noexcept {
+        return size_ == N;
+    }
+
+    VECTOR_CONSTEXPR void Resize(size_t new_size) {
+        if (new_size < size_) {
+            std::destroy_n(begin() + new_size, size_ - new_size);
+        }
+        else {
+            CheckCapacity(new_size);
+            UninitializedValueConstructN(end(), new_size - size_);
+        }
+        size_ = new_size;
+    }
+
+    VECTOR_CONSTEXPR void PopBack() {
+        VECTOR_CHECK(size_ > 0);
+        std::destroy_at(end() - 1);
+        --size_;
+    }
+
+    VECTOR_CONSTEXPR void Clear() noexcept {
+        std::destroy_n(begin(), size_);
+        size_ = 0;
+    }
+
+    VECTOR_CONSTEXPR void Swap(StaticVector& other) noexcept(std::is_nothrow_move_constructible_v<T>
+                                                             && std::is_nothrow_swappable_v<T>) {
+        StaticVector& longer = size_ >= other.size_ ? *this : other;
+        StaticVector& shorter = size_ >= other.size_ ? other : *this;
+        const size_t common = shorter.size_;
+        std::swap_ranges(begin(), begin() + common, other.begin());
+        UninitializedCopyN(std::make_move_iterator(longer.begin() + common), longer.size_ - common, shorter.end());
+        std::destroy_n(longer.begin() + common, longer.size_ - common);
+        std::swap(size_, other.size_);
+    }
+
+    VECTOR_CONSTEXPR iterator Erase(const_iterator pos) {
+        const size_t position = pos - begin();
+        std::move(begin() + position + 1, end(), begin() + position);
+        PopBack();
+        return begin() + position;
+    }
+
+    template <typename Type>
+    VECTOR_CONSTEXPR void PushBack(Type&& value) {
+        EmplaceBack(std::forward<Type>(value));
+    }
+
+    template <typename... Args>
+    VECTOR_CONSTEXPR T& EmplaceBack(Args&&... args) {
+        CheckCapacity(size_ + 1);
+        ConstructAt(end(), std::forward<Args>(args)...);
+        return begin()[size_++];
+    }
+
+    VECTOR_CONSTEXPR const T& operator[](size_t index) const noexcept {
+        return const_cast<StaticVector&>(*this)[index];
+    }
+
+    VECTOR_CONSTEXPR T& operator[](size_t index) noexcept {
+        VECTOR_CHECK(index < size_);
+        return begin()[index];
+    }
+
+    // Доступ с проверкой индекса в любой сборке: за пределами вектора - исключение std::out_of_range
+    VECTOR_CONSTEXPR const T& At(size_t index) const {
+        return const_cast<StaticVector&>(*this).At(index);
+    }
+
+    VECTOR_CONSTEXPR T& At(size_t index) {
+        if (index >= size_) {
+            throw std::out_of_range("StaticVector index out of range");
+        }
+        return begin()[index];
+    }
+
+    VectorView<T> View() noexcept {
+        return VectorView<T>(begin(), size_);
+    }
+    VectorView<const T> View() const noexcept {
+        return VectorView<const T>(begin(), size_);
+    }
+
+    VECTOR_CONSTEXPR StaticVector& operator=(const StaticVector& rhs) {
+        if (this != &rhs) {
+            AssignFrom(rhs.begin(), rhs.size_);
+        }
+        return *this;
+    }
+
+    VECTOR_CONSTEXPR StaticVector& operator=(StaticVector&& rhs) noexcept(std::is_nothrow_move_constructible_v<T>
+                                                                         && std::is_nothrow_move_assignable_v<T>) {
+        if (this != &rhs) {
+            AssignFrom(std::make_move_iterator(rhs.begin()), rhs.size_);
+            rhs.Clear();
+        }
+        return *this;
+    }
+
+private:
+    static_vector_detail::Storage<T, N> storage_;
+    size_t size_ = 0;
+
+    static VECTOR_CONSTEXPR void CheckCapacity(size_t required) {
+        if (required > N) {
+            throw std::length_error("StaticVector capacity exceeded");
+        }
+    }
+
+    // Общие элементы присваиваются, недостающие конструируются, лишние разрушаются
+    template <typename It>
+    VECTOR_CONSTEXPR void AssignFrom(It first, size_t count) {
+        if (size_ <= count) {
+            It mid = std::next(first, size_);
+            std::copy(first, mid, begin());
+            UninitializedCopyN(mid, count - size_, end());
+        }
+        else {
+            std::copy(first, std::next(first, count), begin());
+            std::destroy_n(begin() + count, size_ - count);
+        }
+        size_ = count;
+    }
+};
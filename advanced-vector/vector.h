@@ -1,191 +1,1012 @@
 #pragma once
 
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <new>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <type_traits>
 #include <utility>
 #include <memory>
 #include <algorithm>
+#include <functional>
+#include <exception>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#include "vector_check.h"
+#include "vector_view.h"
+
+// В C++20 (при constexpr std::allocator) основной интерфейс Vector доступен при вычислениях
+// во время компиляции: память, выделенная в константном выражении, должна быть освобождена в нём же.
+// В C++17 VECTOR_CONSTEXPR пуст
+#if __cplusplus >= 202002L && defined(__cpp_lib_constexpr_dynamic_alloc) && defined(__cpp_lib_is_constant_evaluated)
+#define VECTOR_HAS_CONSTEXPR 1
+#define VECTOR_CONSTEXPR constexpr
+#else
+#define VECTOR_HAS_CONSTEXPR 0
+#define VECTOR_CONSTEXPR
+#endif
+
+// Истина во время вычисления константного выражения. Там недоступны memcpy, placement new
+// и стандартные uninitialized-алгоритмы, и вместо них используются поэлементные циклы
+constexpr bool IsConstantEvaluated() noexcept {
+#if VECTOR_HAS_CONSTEXPR
+    return std::is_constant_evaluated();
+#else
+    return false;
+#endif
+}
+
+#if defined(__SANITIZE_ADDRESS__)
+#define VECTOR_HAS_ASAN 1
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define VECTOR_HAS_ASAN 1
+#endif
+#endif
+
+#if defined(VECTOR_HARDENED) && defined(VECTOR_HAS_ASAN)
+#include <sanitizer/common_interface_defs.h>
+#define VECTOR_ANNOTATE_CONTAINER 1
+#else
+#define VECTOR_ANNOTATE_CONTAINER 0
+#endif
+
+// Сбор статистики выделений и роста включается макросом VECTOR_ENABLE_STATS.
+// Без него VECTOR_RECORD_STATS ничего не вычисляет. При вычислениях во время компиляции статистика не ведётся
+#ifdef VECTOR_ENABLE_STATS
+#include "vector_stats.h"
+#define VECTOR_RECORD_STATS(T, event) (IsConstantEvaluated() ? (void)0 : (void)GetVectorStats<T>().event)
+#else
+#define VECTOR_RECORD_STATS(T, event) ((void)0)
+#endif
+
+// Профиль по местам создания векторов и подсказки вместимости включаются макросом
+// VECTOR_ENABLE_PROFILING, см. vector_profile.h. Без него конструкторы не принимают место вызова
+#ifdef VECTOR_ENABLE_PROFILING
+#include "vector_profile.h"
+#define VECTOR_SITE_PARAM , VectorSourceLocation site = VectorSourceLocation::Current()
+#define VECTOR_SITE_ARG , site
+#define VECTOR_SITE_INIT , site_(ProfileSiteFor(site))
+#define VECTOR_PROFILE_REALLOCATION() VectorReallocationTimer reallocation_timer(site_, size_)
+#else
+#define VECTOR_SITE_PARAM
+#define VECTOR_SITE_ARG
+#define VECTOR_SITE_INIT
+#define VECTOR_PROFILE_REALLOCATION() ((void)0)
+#endif
 
 using namespace std;
 
+// Тип можно перенести в другую память побайтовым копированием, не вызывая конструктор перемещения
+// у нового объекта и деструктор у старого. Для тривиально копируемых типов это верно всегда,
+// для остальных трейт включается явной специализацией. Специализировать его для std::string нельзя:
+// в libstdc++ строка с коротким содержимым хранит указатель на собственный внутренний буфер
+template <typename T>
+struct IsTriviallyRelocatable : std::is_trivially_copyable<T> {};
+
+template <typename T>
+struct IsTriviallyRelocatable<std::unique_ptr<T>> : std::true_type {};
+
+template <typename T>
+inline constexpr bool IsTriviallyRelocatableV = IsTriviallyRelocatable<T>::value;
+
+// Создаёт объект в неинициализированной памяти p. В отличие от placement new допустимо в constexpr
+template <typename T, typename... Args>
+VECTOR_CONSTEXPR T* ConstructAt(T* p, Args&&... args) {
+#if VECTOR_HAS_CONSTEXPR
+    return std::construct_at(p, std::forward<Args>(args)...);
+#else
+    return ::new (static_cast<void*>(p)) T(std::forward<Args>(args)...);
+#endif
+}
+
+// Создаёт в неинициализированной памяти dst n объектов, инициализированных значением
+template <typename T>
+VECTOR_CONSTEXPR void UninitializedValueConstructN(T* dst, size_t n) {
+    if (IsConstantEvaluated()) {
+        for (size_t i = 0; i != n; ++i) {
+            ConstructAt(dst + i);
+        }
+        return;
+    }
+    std::uninitialized_value_construct_n(dst, n);
+}
+
+// Создаёт в неинициализированной памяти dst копии n объектов из src.
+// Перемещение используется, только если оно не бросает исключений или копирование невозможно
 template <typename T>
+VECTOR_CONSTEXPR void UninitializedMoveOrCopyN(T* src, size_t n, T* dst) {
+    if (IsConstantEvaluated()) {
+        for (size_t i = 0; i != n; ++i) {
+            if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
+                ConstructAt(dst + i, std::move(src[i]));
+            }
+            else {
+                ConstructAt(dst + i, std::as_const(src[i]));
+            }
+        }
+        return;
+    }
+    if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
+        std::uninitialized_move_n(src, n, dst);
+    }
+    else {
+        std::uninitialized_copy_n(src, n, dst);
+    }
+}
+
+// Переносит n объектов из src в неинициализированную память dst. После вызова объекты в src
+// разрушены. Тривиально перемещаемые типы переносятся одним memcpy без вызова деструкторов
+template <typename T>
+VECTOR_CONSTEXPR void RelocateN(T* src, size_t n, T* dst) {
+    if (IsConstantEvaluated()) {
+        UninitializedMoveOrCopyN(src, n, dst);
+        std::destroy_n(src, n);
+        return;
+    }
+    if constexpr (IsTriviallyRelocatableV<T>) {
+        if (n != 0) {
+            std::memcpy(static_cast<void*>(dst), static_cast<const void*>(src), n * sizeof(T));
+        }
+    }
+    else {
+        UninitializedMoveOrCopyN(src, n, dst);
+        std::destroy_n(src, n);
+    }
+}
+
+// Конструирует в dst копии n элементов диапазона, начинающегося с first.
+// Копирование из указателя на тривиально копируемые элементы сводится к одному memcpy
+template <typename It, typename T>
+VECTOR_CONSTEXPR void UninitializedCopyN(It first, size_t n, T* dst) {
+    if (IsConstantEvaluated()) {
+        for (; n != 0; --n, ++first, ++dst) {
+            ConstructAt(dst, *first);
+        }
+        return;
+    }
+    if constexpr (std::is_trivially_copyable_v<T> && std::is_same_v<It, std::move_iterator<T*>>) {
+        UninitializedCopyN(first.base(), n, dst);
+    }
+    else if constexpr (std::is_trivially_copyable_v<T> && std::is_pointer_v<It>
+                       && std::is_same_v<std::remove_cv_t<std::remove_pointer_t<It>>, T>) {
+        if (n != 0) {
+            std::memcpy(static_cast<void*>(dst), static_cast<const void*>(first), n * sizeof(T));
+        }
+    }
+    else {
+        std::uninitialized_copy_n(first, n, dst);
+    }
+}
+
+template <typename It, typename = void>
+struct IsIterator : std::false_type {};
+
+template <typename It>
+struct IsIterator<It, std::void_t<typename std::iterator_traits<It>::iterator_category>> : std::true_type {};
+
+// Необязательные расширения аллокатора для роста буфера без выделения новой памяти:
+//   bool try_expand(T* p, size_t old_n, size_t new_n) - увеличивает блок на месте, не перемещая его;
+//   T* reallocate(T* p, size_t old_n, size_t new_n)   - меняет размер блока, при необходимости перенося
+//                                                       его побайтово (как realloc), nullptr при неудаче
+template <typename Alloc, typename = void>
+struct HasTryExpand : std::false_type {};
+
+template <typename Alloc>
+struct HasTryExpand<Alloc, std::void_t<decltype(std::declval<Alloc&>().try_expand(
+    std::declval<typename Alloc::value_type*>(), size_t{}, size_t{}))>> : std::true_type {};
+
+template <typename Alloc, typename = void>
+struct HasReallocate : std::false_type {};
+
+template <typename Alloc>
+struct HasReallocate<Alloc, std::void_t<decltype(std::declval<Alloc&>().reallocate(
+    std::declval<typename Alloc::value_type*>(), size_t{}, size_t{}))>> : std::true_type {};
+
+// Аллокатор поверх malloc/realloc/free. Рост блока сначала пробует использовать запас,
+// который malloc уже выделил сверх запрошенного, а затем realloc: для больших блоков glibc
+// обслуживает его через mremap, не копируя страницы и не удерживая старый и новый буферы одновременно
+template <typename T>
+struct ReallocAllocator {
+    static_assert(alignof(T) <= alignof(std::max_align_t), "malloc does not support over-aligned types");
+
+    using value_type = T;
+
+    ReallocAllocator() noexcept = default;
+
+    template <typename U>
+    ReallocAllocator(const ReallocAllocator<U>&) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        void* p = std::malloc(n * sizeof(T));
+        if (p == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(p);
+    }
+
+    void deallocate(T* p, size_t /*n*/) noexcept {
+        std::free(p);
+    }
+
+    bool try_expand(T* p, size_t /*old_n*/, size_t new_n) noexcept {
+#ifdef __GLIBC__
+        return new_n <= malloc_usable_size(p) / sizeof(T);
+#else
+        (void)p;
+        (void)new_n;
+        return false;
+#endif
+    }
+
+    T* reallocate(T* p, size_t /*old_n*/, size_t new_n) noexcept {
+        if (new_n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            return nullptr;
+        }
+        return static_cast<T*>(std::realloc(static_cast<void*>(p), new_n * sizeof(T)));
+    }
+
+    template <typename U>
+    bool operator==(const ReallocAllocator<U>&) const noexcept {
+        return true;
+    }
+    template <typename U>
+    bool operator!=(const ReallocAllocator<U>&) const noexcept {
+        return false;
+    }
+};
+
+template <typename T, typename Alloc = std::allocator<T>>
 class RawMemory {
+    using AllocTraits = std::allocator_traits<Alloc>;
+
 public:
+    using allocator_type = Alloc;
+
     RawMemory() = default;
 
-    explicit RawMemory(size_t capacity)
-        : buffer_(Allocate(capacity))
+    VECTOR_CONSTEXPR explicit RawMemory(const Alloc& alloc) noexcept
+        : alloc_(alloc) {
+    }
+
+    VECTOR_CONSTEXPR explicit RawMemory(size_t capacity, const Alloc& alloc = Alloc())
+        : alloc_(alloc)
+        , buffer_(Allocate(capacity))
         , capacity_(capacity) {
     }
 
-    ~RawMemory() {
+    VECTOR_CONSTEXPR ~RawMemory() {
         Deallocate(buffer_);
     }
 
     RawMemory(const RawMemory&) = delete;
     RawMemory& operator=(const RawMemory& rhs) = delete;
 
-    RawMemory(RawMemory&& other) noexcept
-        : buffer_(exchange(other.buffer_, nullptr))
-        , capacity_(exchange(other.capacity_, 0)) {}
+    // Аллокатор копируется, а не перемещается: источник должен оставаться пригодным для новых выделений
+    VECTOR_CONSTEXPR RawMemory(RawMemory&& other) noexcept
+        : alloc_(other.alloc_)
+        , buffer_(exchange(other.buffer_, nullptr))
+        , capacity_(exchange(other.capacity_, 0)) {
+        other.NextGeneration();
+    }
 
-    RawMemory& operator=(RawMemory&& rhs) noexcept {
+    // Буфер переходит вместе с аллокатором, который сможет его освободить.
+    // Решение о том, допустимо ли это (propagate_on_container_move_assignment), принимает Vector
+    VECTOR_CONSTEXPR RawMemory& operator=(RawMemory&& rhs) noexcept {
         if (this != &rhs) {
-            buffer_ = move(rhs.buffer_);
-            capacity_ = move(rhs.capacity_);
-
-            rhs.buffer_ = nullptr;
-            rhs.capacity_ = 0;
+            Deallocate(buffer_);
+            alloc_ = rhs.alloc_;
+            buffer_ = exchange(rhs.buffer_, nullptr);
+            capacity_ = exchange(rhs.capacity_, 0);
+            NextGeneration();
+            rhs.NextGeneration();
         }
         return *this;
     }
 
-    T* operator+(size_t offset) noexcept {
+    VECTOR_CONSTEXPR T* operator+(size_t offset) noexcept {
         // Разрешается получать адрес ячейки памяти, следующей за последним элементом массива
-        assert(offset <= capacity_);
+        VECTOR_CHECK(offset <= capacity_);
         return buffer_ + offset;
     }
 
-    const T* operator+(size_t offset) const noexcept {
+    VECTOR_CONSTEXPR const T* operator+(size_t offset) const noexcept {
         return const_cast<RawMemory&>(*this) + offset;
     }
 
-    const T& operator[](size_t index) const noexcept {
+    VECTOR_CONSTEXPR const T& operator[](size_t index) const noexcept {
         return const_cast<RawMemory&>(*this)[index];
     }
 
-    T& operator[](size_t index) noexcept {
-        assert(index < capacity_);
+    VECTOR_CONSTEXPR T& operator[](size_t index) noexcept {
+        VECTOR_CHECK(index < capacity_);
         return buffer_[index];
     }
 
-    void Swap(RawMemory& other) noexcept {
-        std::swap(buffer_, other.buffer_);
-        std::swap(capacity_, other.capacity_);
+    VECTOR_CONSTEXPR void Swap(RawMemory& other) noexcept {
+        using std::swap;
+        swap(alloc_, other.alloc_);
+        swap(buffer_, other.buffer_);
+        swap(capacity_, other.capacity_);
+        NextGeneration();
+        other.NextGeneration();
     }
 
-    const T* GetAddress() const noexcept {
+    VECTOR_CONSTEXPR const T* GetAddress() const noexcept {
         return buffer_;
     }
 
-    T* GetAddress() noexcept {
+    VECTOR_CONSTEXPR T* GetAddress() noexcept {
         return buffer_;
     }
 
-    size_t Capacity() const {
+    VECTOR_CONSTEXPR size_t Capacity() const {
         return capacity_;
     }
 
+    VECTOR_CONSTEXPR const Alloc& GetAllocator() const noexcept {
+        return alloc_;
+    }
+
+#ifdef VECTOR_DEBUG_ITERATORS
+    // Номер буфера: меняется при каждой замене буфера, но не при росте на месте через TryExpand.
+    // Отладочные итераторы Vector запоминают его при создании и сверяют при каждом обращении
+    VECTOR_CONSTEXPR uint64_t Generation() const noexcept {
+        return generation_;
+    }
+#endif
+
+    // Можно ли менять размер буфера без выделения нового блока и переноса элементов конструкторами
+    static constexpr bool CAN_EXPAND = HasTryExpand<Alloc>::value;
+    static constexpr bool CAN_REALLOCATE = HasReallocate<Alloc>::value && IsTriviallyRelocatableV<T>;
+
+    // Увеличивает вместимость до new_capacity, не перемещая буфер. Адреса элементов сохраняются
+    VECTOR_CONSTEXPR bool TryExpand(size_t new_capacity) noexcept {
+        if constexpr (CAN_EXPAND) {
+            if (buffer_ != nullptr && alloc_.try_expand(buffer_, capacity_, new_capacity)) {
+                capacity_ = new_capacity;
+                VECTOR_RECORD_STATS(T, OnGrowInPlace(new_capacity));
+                return true;
+            }
+        }
+        (void)new_capacity;
+        return false;
+    }
+
+    // Меняет вместимость, допуская побайтовый перенос буфера на новое место.
+    // Доступно только для тривиально перемещаемых T. При неудаче буфер остаётся прежним
+    VECTOR_CONSTEXPR bool TryReallocate(size_t new_capacity) noexcept {
+        if constexpr (CAN_REALLOCATE) {
+            if (buffer_ != nullptr) {
+                if (T* buffer = alloc_.reallocate(buffer_, capacity_, new_capacity)) {
+                    buffer_ = buffer;
+                    capacity_ = new_capacity;
+                    NextGeneration();
+                    VECTOR_RECORD_STATS(T, OnGrowInPlace(new_capacity));
+                    return true;
+                }
+            }
+        }
+        (void)new_capacity;
+        return false;
+    }
+
+    // Принимает во владение буфер на capacity элементов, выделенный аллокатором, равным GetAllocator().
+    // Текущий буфер освобождается
+    void Adopt(T* buffer, size_t capacity) noexcept {
+        assert(buffer == nullptr || buffer != buffer_);
+        Deallocate(buffer_);
+        buffer_ = buffer;
+        capacity_ = buffer != nullptr ? capacity : 0;
+        NextGeneration();
+    }
+
+    // Отдаёт буфер вызывающему. Освободить его должен аллокатор, равный GetAllocator()
+    T* Release() noexcept {
+        capacity_ = 0;
+        NextGeneration();
+        return exchange(buffer_, nullptr);
+    }
+
 private:
+    [[no_unique_address]] Alloc alloc_;
     T* buffer_ = nullptr;
     size_t capacity_ = 0;
+#ifdef VECTOR_DEBUG_ITERATORS
+    uint64_t generation_ = 0;
+#endif
+
+    VECTOR_CONSTEXPR void NextGeneration() noexcept {
+#ifdef VECTOR_DEBUG_ITERATORS
+        ++generation_;
+#endif
+    }
 
     // Выделяет сырую память под n элементов и возвращает указатель на неё
-    static T* Allocate(size_t n) {
-        return n != 0 ? static_cast<T*>(operator new(n * sizeof(T))) : nullptr;
+    VECTOR_CONSTEXPR T* Allocate(size_t n) {
+        if (n == 0) {
+            return nullptr;
+        }
+        // Выделение, завершившееся исключением, не учитывается
+        T* buffer = AllocTraits::allocate(alloc_, n);
+        VECTOR_RECORD_STATS(T, OnAllocate(n, sizeof(T)));
+        return buffer;
     }
     // Освобождает сырую память, выделенную ранее по адресу buf при помощи Allocate
-    static void Deallocate(T* buf) noexcept {
-        operator delete(buf);
+    VECTOR_CONSTEXPR void Deallocate(T* buf) noexcept {
+        if (buf != nullptr) {
+            AllocTraits::deallocate(alloc_, buf, capacity_);
+        }
     }
 };
 
-template <typename T>
+// Часто используемые выравнивания буфера: кеш-линия (и ширина регистра AVX-512), страница и большая страница
+inline constexpr size_t CACHE_LINE_ALIGNMENT = 64;
+inline constexpr size_t PAGE_ALIGNMENT = 4096;
+inline constexpr size_t HUGE_PAGE_ALIGNMENT = 2 * 1024 * 1024;
+
+// Аллокатор, выравнивающий начало буфера по границе Alignment (но не слабее alignof(T)).
+// Память выделяется выравнивающими operator new/delete, поэтому подходит и для сверхвыровненных типов
+template <typename T, size_t Alignment = CACHE_LINE_ALIGNMENT>
+struct AlignedAllocator {
+    static_assert((Alignment & (Alignment - 1)) == 0, "Alignment must be a power of two");
+
+    using value_type = T;
+
+    static constexpr size_t alignment = std::max(Alignment, alignof(T));
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() noexcept = default;
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<T*>(operator new(n * sizeof(T), std::align_val_t(alignment)));
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        operator delete(p, n * sizeof(T), std::align_val_t(alignment));
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept {
+        return true;
+    }
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment>&) const noexcept {
+        return false;
+    }
+};
+
+// Гарантированное выравнивание начала буфера, выделенного аллокатором. Аллокатор может объявить его
+// статическим членом alignment. Иначе известно только то, что требует сам тип
+template <typename Alloc, typename = void>
+struct AllocatorAlignment
+    : std::integral_constant<size_t, alignof(typename std::allocator_traits<Alloc>::value_type)> {};
+
+template <typename Alloc>
+struct AllocatorAlignment<Alloc, std::void_t<decltype(Alloc::alignment)>>
+    : std::integral_constant<size_t, Alloc::alignment> {};
+
+// Политика роста определяет вместимость буфера, когда в нём не осталось места.
+// Любой тип со статической функцией
+//   size_t NextCapacity(size_t capacity, size_t required, size_t elem_size)
+// может быть передан в Vector как политика. Результат должен быть не меньше required.
+// Для использования Vector во время компиляции функция должна быть constexpr
+
+// Удвоение вместимости
+struct DoublingGrowth {
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t /*elem_size*/) noexcept {
+        if (capacity > std::numeric_limits<size_t>::max() / 2) {
+            return std::max(capacity, required);
+        }
+        return std::max(capacity == 0 ? 1 : capacity * 2, required);
+    }
+};
+
+// Рост в полтора раза: меньше неиспользуемой памяти ценой более частых реаллокаций
+struct OneAndHalfGrowth {
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t /*elem_size*/) noexcept {
+        const size_t step = std::max<size_t>(capacity / 2, 1);
+        if (capacity > std::numeric_limits<size_t>::max() - step) {
+            return std::max(capacity, required);
+        }
+        return std::max(capacity + step, required);
+    }
+};
+
+// Первый буфер занимает не меньше одной кеш-линии, дальше работает политика Base.
+// Убирает серию реаллокаций 1, 2, 4, 8 на первых вставках
+template <typename Base = DoublingGrowth, size_t LineSize = 64>
+struct CacheLineGrowth {
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t elem_size) noexcept {
+        if (capacity == 0) {
+            return std::max<size_t>({ LineSize / elem_size, required, 1 });
+        }
+        return Base::NextCapacity(capacity, required, elem_size);
+    }
+};
+
+// Начиная с Threshold байт вместимость, выбранная Base, округляется вверх до целого числа страниц,
+// чтобы хвост последней страницы не пропадал впустую
+template <typename Base = DoublingGrowth, size_t PageSize = 4096, size_t Threshold = 16 * PageSize>
+struct PageGrowth {
+    static_assert((PageSize & (PageSize - 1)) == 0, "PageSize must be a power of two");
+
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t elem_size) noexcept {
+        const size_t next = Base::NextCapacity(capacity, required, elem_size);
+        if (next > std::numeric_limits<size_t>::max() / elem_size - PageSize) {
+            return next;
+        }
+        const size_t bytes = next * elem_size;
+        if (bytes < Threshold) {
+            return next;
+        }
+        return ((bytes + PageSize - 1) & ~(PageSize - 1)) / elem_size;
+    }
+};
+
+// Тег конструктора, создающего элементы инициализацией по умолчанию. Для тривиальных типов
+// память не обнуляется, что экономит запись буфера, который сразу будет перезаписан (read, recv, SIMD)
+struct DefaultInitTag {
+    explicit DefaultInitTag() = default;
+};
+
+inline constexpr DefaultInitTag DEFAULT_INIT{};
+
+// Тег параллельных массовых операций: конструирования, копирования и разрушения элементов.
+// threads == 0 - по числу аппаратных потоков. Небольшие диапазоны обрабатываются в вызывающем потоке
+struct ParallelTag {
+    explicit constexpr ParallelTag(size_t threads = 0) noexcept
+        : threads(threads) {
+    }
+
+    size_t threads;
+};
+
+inline constexpr ParallelTag PARALLEL{};
+
+// Минимальный объём участка, ради которого стоит запускать отдельный поток
+inline constexpr size_t PARALLEL_MIN_CHUNK_BYTES = size_t{ 1 } << 20;
+
+// Делит [0, n) на участки и вызывает f(begin, end) для каждого в своём потоке. Границы участков
+// кратны странице: каждая страница буфера впервые записывается одним потоком и при first-touch
+// размещается на узле NUMA этого потока. Если участок выбросил исключение, для успешно обработанных
+// участков вызывается undo(begin, end) и пробрасывается первое исключение. Если поток не удалось
+// создать, его участки обрабатываются в вызывающем потоке
+template <typename T, typename F, typename Undo>
+void ParallelForChunks(ParallelTag tag, size_t n, F f, Undo undo) {
+    const size_t page_elems = std::max<size_t>(1, PAGE_ALIGNMENT / sizeof(T));
+    const size_t min_chunk = std::max(page_elems, PARALLEL_MIN_CHUNK_BYTES / sizeof(T));
+    size_t threads = tag.threads != 0 ? tag.threads : std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min(threads, std::max<size_t>(1, n / min_chunk));
+    if (threads <= 1) {
+        f(size_t{ 0 }, n);
+        return;
+    }
+
+    const size_t chunk = ((n + threads - 1) / threads + page_elems - 1) / page_elems * page_elems;
+    threads = (n + chunk - 1) / chunk;
+
+    std::unique_ptr<std::exception_ptr[]> errors(new std::exception_ptr[threads]);
+    std::unique_ptr<std::thread[]> workers(new std::thread[threads]);
+    auto run = [&](size_t i) noexcept {
+        try {
+            f(i * chunk, std::min(n, (i + 1) * chunk));
+        }
+        catch (...) {
+            errors[i] = std::current_exception();
+        }
+    };
+
+    size_t started = 1;
+    try {
+        for (; started < threads; ++started) {
+            workers[started] = std::thread(run, started);
+        }
+    }
+    catch (...) {
+        // system_error или bad_alloc при создании состояния потока: уже запущенные потоки
+        // обязательно дожидаются ниже, а оставшиеся участки выполняются здесь
+    }
+    run(0);
+    for (size_t i = started; i < threads; ++i) {
+        run(i);
+    }
+    for (size_t i = 1; i < started; ++i) {
+        workers[i].join();
+    }
+
+    std::exception_ptr first_error;
+    for (size_t i = 0; i < threads; ++i) {
+        if (errors[i] && !first_error) {
+            first_error = errors[i];
+        }
+    }
+    if (first_error) {
+        for (size_t i = 0; i < threads; ++i) {
+            if (!errors[i]) {
+                undo(i * chunk, std::min(n, (i + 1) * chunk));
+            }
+        }
+        std::rethrow_exception(first_error);
+    }
+}
+
+// Неизменяемый разделяемый снимок вектора, см. shared_vector.h
+template <typename T, typename Alloc = std::allocator<T>, typename Growth = DoublingGrowth>
+class SharedVector;
+
+template <typename T, typename Alloc = std::allocator<T>, typename Growth = DoublingGrowth>
 class Vector {
+    using AllocTraits = std::allocator_traits<Alloc>;
+
 public:
 
+#ifdef VECTOR_DEBUG_ITERATORS
+    template <bool IsConst>
+    class CheckedIterator;
+
+    using iterator = CheckedIterator<false>;
+    using const_iterator = CheckedIterator<true>;
+#else
     using iterator = T*;
     using const_iterator = const T*;
+#endif
+    using allocator_type = Alloc;
+    using growth_policy = Growth;
 
+    // Выравнивание, которое гарантируется для begin() при ненулевой вместимости
+    static constexpr size_t ALIGNMENT = AllocatorAlignment<Alloc>::value;
+
+#ifdef VECTOR_ENABLE_PROFILING
+    VECTOR_CONSTEXPR Vector(VectorSourceLocation site = VectorSourceLocation::Current()) noexcept
+        : site_(ProfileSiteFor(site)) {
+    }
+#else
     Vector() = default;
+#endif
+
+    VECTOR_CONSTEXPR explicit Vector(const Alloc& alloc VECTOR_SITE_PARAM) noexcept
+        : data_(alloc) VECTOR_SITE_INIT {
+    }
+
+    VECTOR_CONSTEXPR explicit Vector(size_t size, const Alloc& alloc = Alloc() VECTOR_SITE_PARAM)
+        : data_(size, alloc)
+        , size_(size) VECTOR_SITE_INIT  //
+    {
+        UninitializedValueConstructN(data_.GetAddress(), size);
+    }
 
-    explicit Vector(size_t size)
-        : data_(size)
-        , size_(size)  //
+    Vector(size_t size, DefaultInitTag, const Alloc& alloc = Alloc() VECTOR_SITE_PARAM)
+        : data_(size, alloc)
+        , size_(size) VECTOR_SITE_INIT  //
     {
-        uninitialized_value_construct_n(data_.GetAddress(), size);
+        uninitialized_default_construct_n(data_.GetAddress(), size);
     }
 
-    Vector(const Vector& other)
-        : data_(other.size_)
-        , size_(other.size_)
+    // Создаёт элементы параллельно, участками по несколько страниц на поток
+    Vector(ParallelTag tag, size_t size, const Alloc& alloc = Alloc() VECTOR_SITE_PARAM)
+        : data_(size, alloc)
+        , size_(size) VECTOR_SITE_INIT  //
     {
-        uninitialized_copy_n(other.data_.GetAddress(), size_, data_.GetAddress());
+        T* data = data_.GetAddress();
+        ParallelForChunks<T>(
+            tag, size,
+            [data](size_t begin, size_t end) {
+                uninitialized_value_construct_n(data + begin, end - begin);
+            },
+            [data](size_t begin, size_t end) {
+                std::destroy_n(data + begin, end - begin);
+            });
+    }
+
+    VECTOR_CONSTEXPR Vector(const Vector& other VECTOR_SITE_PARAM)
+        : Vector(other, AllocTraits::select_on_container_copy_construction(other.GetAllocator()) VECTOR_SITE_ARG) {
+    }
+
+    Vector(ParallelTag tag, const Vector& other VECTOR_SITE_PARAM)
+        : Vector(tag, other, AllocTraits::select_on_container_copy_construction(other.GetAllocator()) VECTOR_SITE_ARG) {
+    }
+
+    // Копирует элементы параллельно. При исключении уже скопированные участки разрушаются
+    Vector(ParallelTag tag, const Vector& other, const Alloc& alloc VECTOR_SITE_PARAM)
+        : data_(other.size_, alloc)
+        , size_(other.size_) VECTOR_SITE_INIT
+    {
+        const T* src = other.data_.GetAddress();
+        T* dst = data_.GetAddress();
+        ParallelForChunks<T>(
+            tag, size_,
+            [src, dst](size_t begin, size_t end) {
+                UninitializedCopyN(src + begin, end - begin, dst + begin);
+            },
+            [dst](size_t begin, size_t end) {
+                std::destroy_n(dst + begin, end - begin);
+            });
+    }
+
+    VECTOR_CONSTEXPR Vector(const Vector& other, const Alloc& alloc VECTOR_SITE_PARAM)
+        : data_(other.size_, alloc)
+        , size_(other.size_) VECTOR_SITE_INIT
+    {
+        UninitializedCopyN(other.data_.GetAddress(), size_, data_.GetAddress());
+    }
+
+    template <typename It, typename = std::enable_if_t<IsIterator<It>::value>>
+    VECTOR_CONSTEXPR Vector(It first, It last, const Alloc& alloc = Alloc() VECTOR_SITE_PARAM)
+        : data_(alloc) VECTOR_SITE_INIT {
+        try {
+            Assign(first, last);
+        }
+        catch (...) {
+            // Деструктор не будет вызван: созданные однопроходным Assign элементы разрушаются здесь
+            UnpoisonTail();
+            std::destroy_n(data_.GetAddress(), size_);
+            throw;
+        }
+    }
+
+    VECTOR_CONSTEXPR Vector(std::initializer_list<T> init, const Alloc& alloc = Alloc() VECTOR_SITE_PARAM)
+        : Vector(init.begin(), init.end(), alloc VECTOR_SITE_ARG) {
     }
-    Vector(Vector&& other) noexcept
+
+    // Перемещённый вектор остаётся отнесённым к месту создания источника
+    VECTOR_CONSTEXPR Vector(Vector&& other) noexcept
         : data_(move(other.data_))
-        , size_(exchange(other.size_, 0)) {}
+        , size_(exchange(other.size_, 0))
+#ifdef VECTOR_ENABLE_PROFILING
+        , site_(other.site_)
+#endif
+    {
+    }
 
-    ~Vector() {
+    VECTOR_CONSTEXPR ~Vector() {
+        VECTOR_RECORD_STATS(T, OnDestroy(size_, Capacity()));
+#ifdef VECTOR_ENABLE_PROFILING
+        if (site_ != nullptr) {
+            site_->OnDestroy(size_, Capacity());
+        }
+#endif
+        UnpoisonTail();
         destroy_n(data_.GetAddress(), size_);
     }
 
-    iterator begin() noexcept {
-        return data_.GetAddress();
+    VECTOR_CONSTEXPR iterator begin() noexcept {
+        return MakeIterator(data_.GetAddress());
     }
-    iterator end() noexcept {
-        return data_.GetAddress() + size_;
+    VECTOR_CONSTEXPR iterator end() noexcept {
+        return MakeIterator(data_.GetAddress() + size_);
     }
-    const_iterator begin() const noexcept {
-        return data_.GetAddress();
+    VECTOR_CONSTEXPR const_iterator begin() const noexcept {
+        return MakeIterator(data_.GetAddress());
     }
-    const_iterator end() const noexcept {
-        return data_.GetAddress() + size_;
+    VECTOR_CONSTEXPR const_iterator end() const noexcept {
+        return MakeIterator(data_.GetAddress() + size_);
     }
-    const_iterator cbegin() const noexcept {
-        return data_.GetAddress();
+    VECTOR_CONSTEXPR const_iterator cbegin() const noexcept {
+        return begin();
     }
-    const_iterator cend() const noexcept {
-        return data_.GetAddress() + size_;
+    VECTOR_CONSTEXPR const_iterator cend() const noexcept {
+        return end();
     }
 
-    size_t Size() const noexcept {
+    VECTOR_CONSTEXPR size_t Size() const noexcept {
         return size_;
     }
 
-    size_t Capacity() const noexcept {
+    VECTOR_CONSTEXPR size_t Capacity() const noexcept {
         return data_.Capacity();
     }
 
-    void Reserve(size_t new_capacity) {
+    VECTOR_CONSTEXPR Alloc GetAllocator() const noexcept {
+        return data_.GetAllocator();
+    }
+
+    VECTOR_CONSTEXPR void Reserve(size_t new_capacity) {
         if (new_capacity <= Capacity()) {
             return;
         }
-        RawMemory<T> new_data(new_capacity);
-
-        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
-            std::uninitialized_move_n(data_.GetAddress(), size_, new_data.GetAddress());
+        AnnotationScope annotation(*this);
+        if (data_.TryExpand(new_capacity)) {
+            return;
         }
-        else {
-            std::uninitialized_copy_n(data_.GetAddress(), size_, new_data.GetAddress());
+        VECTOR_PROFILE_REALLOCATION();
+        if (data_.TryReallocate(new_capacity)) {
+            return;
+        }
+        RawMemory<T, Alloc> new_data(new_capacity, data_.GetAllocator());
+        RelocateN(data_.GetAddress(), size_, new_data.GetAddress());
+        if (Capacity() != 0) {
+            VECTOR_RECORD_STATS(T, OnRelocate(size_));
         }
-
-        std::destroy_n(data_.GetAddress(), size_);
         data_.Swap(new_data);
     }
 
-    void Swap(Vector& other) noexcept {
+    // Без propagate_on_container_swap обмен допустим только между равными аллокаторами,
+    // поэтому и обмен самими аллокаторами в RawMemory ничего не меняет
+    VECTOR_CONSTEXPR void Swap(Vector& other) noexcept {
+        if constexpr (!AllocTraits::propagate_on_container_swap::value) {
+            assert(GetAllocator() == other.GetAllocator());
+        }
+        AnnotationScope annotation(*this);
+        AnnotationScope other_annotation(other);
         data_.Swap(other.data_);
         swap(size_, other.size_);
     }
 
-    void Resize(size_t new_size) {
+    VECTOR_CONSTEXPR void Resize(size_t new_size) {
+        AnnotationScope annotation(*this);
+        if (new_size < size_) {
+            std::destroy_n(data_.GetAddress() + new_size, size_ - new_size);
+        }
+        else {
+            Reserve(new_size);
+            UninitializedValueConstructN(data_.GetAddress() + size_, new_size - size_);
+        }
+        size_ = new_size;
+    }
+
+    // Как Resize, но новые элементы инициализируются по умолчанию: у тривиальных типов они
+    // остаются неинициализированными и должны быть записаны до чтения
+    void ResizeDefaultInit(size_t new_size) {
+        AnnotationScope annotation(*this);
         if (new_size < size_) {
             std::destroy_n(data_.GetAddress() + new_size, size_ - new_size);
         }
         else {
             Reserve(new_size);
-            uninitialized_value_construct_n(data_.GetAddress() + size_, new_size - size_);
+            uninitialized_default_construct_n(data_.GetAddress() + size_, new_size - size_);
         }
         size_ = new_size;
     }
 
-    void PopBack() {
+    // Меняет размер, не трогая память новых элементов: значения новых элементов - байты, уже лежащие
+    // в буфере (например, в отображённом файле). Только для тривиально копируемых типов, даже если
+    // у них есть инициализаторы членов по умолчанию
+    void ResizeUninitialized(size_t new_size) {
+        static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>,
+                      "ResizeUninitialized requires a trivially copyable element type");
+        AnnotationScope annotation(*this);
+        Reserve(new_size);
+        size_ = new_size;
+    }
+
+    VECTOR_CONSTEXPR void PopBack() {
+        VECTOR_CHECK(size_ > 0);
+        AnnotationScope annotation(*this);
         std::destroy_at(data_.GetAddress() + size_ - 1);
         --size_;
     }
 
+    // Разрушает все элементы, сохраняя вместимость
+    VECTOR_CONSTEXPR void Clear() noexcept {
+        AnnotationScope annotation(*this);
+        std::destroy_n(data_.GetAddress(), size_);
+        size_ = 0;
+    }
+
+    // Разрушает элементы параллельно. Для больших векторов вызывается перед разрушением,
+    // чтобы деструктор не обходил элементы в одном потоке
+    void Clear(ParallelTag tag) noexcept {
+        AnnotationScope annotation(*this);
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            T* data = data_.GetAddress();
+            try {
+                ParallelForChunks<T>(
+                    tag, size_,
+                    [data](size_t begin, size_t end) noexcept {
+                        std::destroy_n(data + begin, end - begin);
+                    },
+                    [](size_t, size_t) noexcept {});
+            }
+            catch (...) {
+                // Исключение возможно только при выделении служебных массивов, до разрушения элементов
+                std::destroy_n(data, size_);
+            }
+        }
+        size_ = 0;
+    }
+
+    // Копирующее присваивание с параллельным копированием. Копия строится в новом буфере,
+    // поэтому при исключении вектор не меняется
+    void CopyFrom(ParallelTag tag, const Vector& rhs) {
+        if (this == &rhs) {
+            return;
+        }
+        Vector rhs_copy(tag, rhs,
+                        AllocTraits::propagate_on_container_copy_assignment::value ? rhs.GetAllocator() : GetAllocator());
+        AnnotationScope annotation(*this);
+        Clear(tag);
+        data_ = std::move(rhs_copy.data_);
+        size_ = exchange(rhs_copy.size_, 0);
+    }
+
+    // Разрушает все элементы и освобождает буфер
+    void ClearAndRelease() noexcept {
+        AnnotationScope annotation(*this);
+        Clear();
+        data_ = RawMemory<T, Alloc>(data_.GetAllocator());
+    }
+
+    // Буфер, отданный Release: элементы [data, data + size) живы, память рассчитана на capacity элементов
+    struct ReleasedBuffer {
+        T* data = nullptr;
+        size_t size = 0;
+        size_t capacity = 0;
+    };
+
+    // Принимает во владение буфер без копирования элементов: первые size из capacity элементов
+    // должны быть созданы, а память - выделена аллокатором, равным GetAllocator()
+    // (для ReallocAllocator - через malloc, поэтому подходят буферы из C API).
+    // Прежние элементы разрушаются, прежний буфер освобождается
+    void Adopt(T* data, size_t size, size_t capacity) noexcept {
+        assert(size <= capacity);
+        AnnotationScope annotation(*this);
+        std::destroy_n(data_.GetAddress(), size_);
+        data_.Adopt(data, capacity);
+        size_ = data != nullptr ? size : 0;
+    }
+
+    // Отдаёт буфер вместе с элементами и оставляет вектор пустым. Вызывающий разрушает элементы
+    // и освобождает память аллокатором, равным GetAllocator(), либо передаёт буфер в Adopt
+    [[nodiscard]] ReleasedBuffer Release() noexcept {
+        AnnotationScope annotation(*this);
+        ReleasedBuffer released{ data_.GetAddress(), size_, data_.Capacity() };
+        data_.Release();
+        size_ = 0;
+        return released;
+    }
+
+    // Переносит элементы в неизменяемый снимок без копирования и оставляет вектор пустым.
+    // Копии снимка разделяют буфер (определено в shared_vector.h)
+    [[nodiscard]] SharedVector<T, Alloc, Growth> Freeze();
+
+    // Уменьшает вместимость до размера. Тривиально перемещаемые элементы переносятся одним memcpy
+    // или остаются на месте, если аллокатор умеет уменьшать блок через reallocate
+    void ShrinkToFit() {
+        if (Capacity() == size_) {
+            return;
+        }
+        AnnotationScope annotation(*this);
+        if (size_ == 0) {
+            ClearAndRelease();
+            return;
+        }
+        if (data_.TryReallocate(size_)) {
+            return;
+        }
+        RawMemory<T, Alloc> new_data(size_, data_.GetAllocator());
+        RelocateN(data_.GetAddress(), size_, new_data.GetAddress());
+        VECTOR_RECORD_STATS(T, OnRelocate(size_));
+        data_.Swap(new_data);
+    }
+
     iterator Insert(const_iterator pos, const T& value) {
         return Emplace(pos, value);
     }
@@ -193,50 +1014,184 @@ public:
         return Emplace(pos, move(value));
     }
 
+    // Вставляет count копий value. Хвост сдвигается один раз, память выделяется не более одного раза
+    iterator Insert(const_iterator pos, size_t count, const T& value);
+
+    // Вставляет диапазон [first, last), который не должен указывать на элементы самого вектора.
+    // Для однонаправленных итераторов память выделяется не более одного раза, а хвост сдвигается один раз
+    template <typename It, typename = std::enable_if_t<IsIterator<It>::value>>
+    iterator Insert(const_iterator pos, It first, It last);
+
+    iterator Insert(const_iterator pos, std::initializer_list<T> init) {
+        return Insert(pos, init.begin(), init.end());
+    }
+
+    template <typename It, typename = std::enable_if_t<IsIterator<It>::value>>
+    void Append(It first, It last) {
+        Insert(end(), first, last);
+    }
+
+    void Append(std::initializer_list<T> init) {
+        Insert(end(), init.begin(), init.end());
+    }
+
+    // Заменяет содержимое вектора элементами диапазона [first, last)
+    template <typename It, typename = std::enable_if_t<IsIterator<It>::value>>
+    VECTOR_CONSTEXPR void Assign(It first, It last);
+
+    VECTOR_CONSTEXPR void Assign(std::initializer_list<T> init) {
+        Assign(init.begin(), init.end());
+    }
+
     iterator Erase(const_iterator pos) {
-        int position = pos - begin();
+        return Erase(pos, pos + 1);
+    }
 
-        std::move(begin() + position + 1, end(), begin() + position);
-        std::destroy_at(end() - 1);
-        size_ -= 1;
-        
+    // Удаляет элементы [first, last), сдвигая хвост один раз
+    iterator Erase(const_iterator first, const_iterator last) {
+        const size_t position = PositionOf(first);
+        VECTOR_CHECK(first <= last);
+        const size_t count = PositionOf(last) - position;
+        AnnotationScope annotation(*this);
+        T* const dst = data_.GetAddress() + position;
+        T* const old_end = data_.GetAddress() + size_;
+
+        if constexpr (IsTriviallyRelocatableV<T>) {
+            std::destroy_n(dst, count);
+            std::memmove(static_cast<void*>(dst), static_cast<const void*>(dst + count),
+                         (size_ - position - count) * sizeof(T));
+        }
+        else {
+            std::move(dst + count, old_end, dst);
+            std::destroy_n(old_end - count, count);
+        }
+        size_ -= count;
+
+        return begin() + position;
+    }
+
+    // Удаляет элемент за O(1), перемещая на его место последний элемент. Порядок элементов не сохраняется
+    iterator SwapErase(const_iterator pos) {
+        const size_t position = PositionOf(pos);
+        VECTOR_CHECK(position < size_);
+        T* const dst = data_.GetAddress() + position;
+        T* const last = data_.GetAddress() + size_ - 1;
+        if (dst != last) {
+            *dst = std::move(*last);
+        }
+        PopBack();
         return begin() + position;
     }
 
+    // Удаляет за один проход все элементы, удовлетворяющие pred, сохраняя порядок остальных.
+    // Возвращает количество удалённых элементов
+    template <typename Predicate>
+    size_t RemoveIf(Predicate pred) {
+        T* const old_end = data_.GetAddress() + size_;
+        T* const new_end = std::remove_if(data_.GetAddress(), old_end, pred);
+        const size_t count = old_end - new_end;
+        AnnotationScope annotation(*this);
+        std::destroy_n(new_end, count);
+        size_ -= count;
+        return count;
+    }
+
     template <typename Type>
-    void PushBack(Type&& value);
+    VECTOR_CONSTEXPR void PushBack(Type&& value);
 
     template <typename... Args>
-    T& EmplaceBack(Args&&... args);
+    VECTOR_CONSTEXPR T& EmplaceBack(Args&&... args);
 
     template <typename... Args>
     iterator Emplace(const_iterator pos, Args&&... args);
 
-    const T& operator[](size_t index) const noexcept {
+    VECTOR_CONSTEXPR const T& operator[](size_t index) const noexcept {
         /*
         const_cast - чтобы снять константность с ссылки на текущий объект
         и вызвать неконстантную версию оператора [].
-        Так получится избавиться от дублирования проверки assert(index < size)
+        Так получится избавиться от дублирования проверки index < size
         */
         return const_cast<Vector&>(*this)[index];
     }
 
-    T& operator[](size_t index) noexcept {
-        assert(index < size_);
+    VECTOR_CONSTEXPR T& operator[](size_t index) noexcept {
+        VECTOR_CHECK(index < size_);
+        return data_[index];
+    }
+
+    // Доступ с проверкой индекса в любой сборке: за пределами вектора - исключение std::out_of_range
+    VECTOR_CONSTEXPR const T& At(size_t index) const {
+        return const_cast<Vector&>(*this).At(index);
+    }
+
+    VECTOR_CONSTEXPR T& At(size_t index) {
+        if (index >= size_) {
+            throw std::out_of_range("Vector index out of range");
+        }
         return data_[index];
     }
 
-    Vector& operator=(const Vector& rhs) {
+    // Невладеющие представления элементов. Действительны, пока буфер не перераспределён
+    VectorView<T> View() noexcept {
+        return VectorView<T>(data_.GetAddress(), size_);
+    }
+    VectorView<const T> View() const noexcept {
+        return VectorView<const T>(data_.GetAddress(), size_);
+    }
+
+    operator VectorView<T>() noexcept {
+        return View();
+    }
+    operator VectorView<const T>() const noexcept {
+        return View();
+    }
+
+    VectorView<T> Subspan(size_t offset, size_t count = VectorView<T>::NPOS) noexcept {
+        return View().Subspan(offset, count);
+    }
+    VectorView<const T> Subspan(size_t offset, size_t count = VectorView<T>::NPOS) const noexcept {
+        return View().Subspan(offset, count);
+    }
+
+    StridedView<T> Strided(size_t stride) noexcept {
+        return View().Strided(stride);
+    }
+    StridedView<const T> Strided(size_t stride) const noexcept {
+        return View().Strided(stride);
+    }
+
+    ChunkRange<T> Chunks(size_t count) noexcept {
+        return View().Chunks(count);
+    }
+    ChunkRange<const T> Chunks(size_t count) const noexcept {
+        return View().Chunks(count);
+    }
+
+    VECTOR_CONSTEXPR Vector& operator=(const Vector& rhs) {
         if (this != &rhs) {
+            AnnotationScope annotation(*this);
+            if constexpr (AllocTraits::propagate_on_container_copy_assignment::value) {
+                if (GetAllocator() != rhs.GetAllocator()) {
+                    // Память, выделенная нашим аллокатором, должна быть освобождена им же,
+                    // поэтому копия строится сразу на аллокаторе rhs
+                    Vector rhs_copy(rhs, rhs.GetAllocator());
+                    std::destroy_n(data_.GetAddress(), size_);
+                    data_ = std::move(rhs_copy.data_);
+                    size_ = exchange(rhs_copy.size_, 0);
+                    return *this;
+                }
+            }
             if (rhs.size_ > Capacity()) {
-                Vector rhs_copy(rhs);
+                // Аллокатор не распространяется, поэтому копия строится на нашем
+                // аллокаторе: иначе Swap обменял бы буферы разных аллокаторов
+                Vector rhs_copy(rhs, GetAllocator());
                 Swap(rhs_copy);
             }
             else {
                 if (size_ <= rhs.size_) {
 
                     std::copy(rhs.data_.GetAddress(), rhs.data_.GetAddress() + size_, data_.GetAddress());
-                    std::uninitialized_copy_n(rhs.data_.GetAddress() + size_, rhs.size_ - size_, data_.GetAddress() + size_);
+                    UninitializedCopyN(rhs.data_.GetAddress() + size_, rhs.size_ - size_, data_.GetAddress() + size_);
                 }
                 else {
                     std::copy(rhs.data_.GetAddress(), rhs.data_.GetAddress() + rhs.size_, data_.GetAddress());
@@ -247,14 +1202,230 @@ public:
         }
         return *this;
     }
-    Vector& operator=(Vector&& rhs) noexcept {
-        Swap(rhs);
+    VECTOR_CONSTEXPR Vector& operator=(std::initializer_list<T> init) {
+        Assign(init.begin(), init.end());
+        return *this;
+    }
+
+    VECTOR_CONSTEXPR Vector& operator=(Vector&& rhs) noexcept(AllocTraits::propagate_on_container_move_assignment::value
+                                             || AllocTraits::is_always_equal::value) {
+        if (this == &rhs) {
+            return *this;
+        }
+        AnnotationScope annotation(*this);
+        AnnotationScope rhs_annotation(rhs);
+        if (AllocTraits::propagate_on_container_move_assignment::value
+            || AllocTraits::is_always_equal::value
+            || GetAllocator() == rhs.GetAllocator()) {
+            std::destroy_n(data_.GetAddress(), size_);
+            data_ = std::move(rhs.data_);
+            size_ = exchange(rhs.size_, 0);
+        }
+        else {
+            // Чужой буфер забрать нельзя: наш аллокатор не сможет его освободить.
+            // Перемещаем элементы поштучно в память своего аллокатора
+            RawMemory<T, Alloc> new_data(rhs.size_, data_.GetAllocator());
+            std::uninitialized_move_n(rhs.data_.GetAddress(), rhs.size_, new_data.GetAddress());
+            std::destroy_n(data_.GetAddress(), size_);
+            data_.Swap(new_data);
+            size_ = rhs.size_;
+        }
         return *this;
     }
 
 private:
-    RawMemory<T> data_;
+    RawMemory<T, Alloc> data_;
     size_t size_ = 0;
+#ifdef VECTOR_ENABLE_PROFILING
+    VectorProfileSite* site_ = nullptr;
+
+    static VECTOR_CONSTEXPR VectorProfileSite* ProfileSiteFor(const VectorSourceLocation& site) noexcept {
+        if (IsConstantEvaluated()) {
+            return nullptr;
+        }
+        VectorProfileSite* profile = VectorProfiler::Instance().SiteFor(site, sizeof(T));
+        if (profile != nullptr) {
+            profile->OnConstruct();
+        }
+        return profile;
+    }
+#endif
+#if VECTOR_ANNOTATE_CONTAINER
+    // Глубина вложенных AnnotationScope: разметка снимается и восстанавливается только на внешнем уровне
+    unsigned annotation_depth_ = 0;
+#endif
+
+    VECTOR_CONSTEXPR iterator MakeIterator(T* p) noexcept {
+#ifdef VECTOR_DEBUG_ITERATORS
+        return iterator(this, p);
+#else
+        return p;
+#endif
+    }
+    VECTOR_CONSTEXPR const_iterator MakeIterator(const T* p) const noexcept {
+#ifdef VECTOR_DEBUG_ITERATORS
+        return const_iterator(this, p);
+#else
+        return p;
+#endif
+    }
+
+    // Индекс позиции pos, которая должна лежать в [begin(), end()]
+    VECTOR_CONSTEXPR size_t PositionOf(const_iterator pos) const noexcept {
+        VECTOR_CHECK(pos >= cbegin() && pos <= cend());
+        return static_cast<size_t>(pos - cbegin());
+    }
+
+    // Переводит разметку ASan хвоста [begin + size, begin + capacity) из состояния old_mid в new_mid.
+    // Начало буфера должно быть выровнено по 8 байт, а последние байты буфера, делящие 8-байтовую
+    // гранулу теневой памяти с соседним объектом (например, в арене), не размечаются
+    VECTOR_CONSTEXPR void AnnotateContainer(const T* old_mid, const T* new_mid) const noexcept {
+#if VECTOR_ANNOTATE_CONTAINER
+        constexpr uintptr_t GRANULE = 8;
+        const T* const buffer = data_.GetAddress();
+        if (IsConstantEvaluated() || buffer == nullptr || reinterpret_cast<uintptr_t>(buffer) % GRANULE != 0) {
+            return;
+        }
+        const uintptr_t begin = reinterpret_cast<uintptr_t>(buffer);
+        const uintptr_t end = reinterpret_cast<uintptr_t>(buffer + data_.Capacity()) & ~(GRANULE - 1);
+        if (end <= begin) {
+            return;
+        }
+        const auto clamp = [end](const T* mid) {
+            return reinterpret_cast<const void*>(std::min(reinterpret_cast<uintptr_t>(mid), end));
+        };
+        __sanitizer_annotate_contiguous_container(reinterpret_cast<const void*>(begin),
+                                                  reinterpret_cast<const void*>(end), clamp(old_mid), clamp(new_mid));
+#else
+        (void)old_mid;
+        (void)new_mid;
+#endif
+    }
+
+    // Делает весь буфер доступным: перед записью за size_, освобождением и заменой буфера
+    VECTOR_CONSTEXPR void UnpoisonTail() const noexcept {
+        AnnotateContainer(data_.GetAddress() + size_, data_.GetAddress() + data_.Capacity());
+    }
+
+    // Помечает недоступным хвост полностью доступного буфера
+    VECTOR_CONSTEXPR void PoisonTail() const noexcept {
+        AnnotateContainer(data_.GetAddress() + data_.Capacity(), data_.GetAddress() + size_);
+    }
+
+    // Снимает разметку ASan на время операции, которая пишет за size_ или меняет буфер, и
+    // восстанавливает её по новому размеру при выходе, в том числе по исключению.
+    // Без разметки ничего не делает
+    class AnnotationScope {
+    public:
+        VECTOR_CONSTEXPR explicit AnnotationScope(Vector& vector) noexcept
+            : vector_(vector) {
+#if VECTOR_ANNOTATE_CONTAINER
+            if (vector_.annotation_depth_++ == 0) {
+                vector_.UnpoisonTail();
+            }
+#endif
+        }
+
+        AnnotationScope(const AnnotationScope&) = delete;
+        AnnotationScope& operator=(const AnnotationScope&) = delete;
+
+        VECTOR_CONSTEXPR ~AnnotationScope() {
+#if VECTOR_ANNOTATE_CONTAINER
+            if (--vector_.annotation_depth_ == 0) {
+                vector_.PoisonTail();
+            }
+#endif
+        }
+
+    private:
+        [[maybe_unused]] Vector& vector_;
+    };
+
+    // Однонаправленный итератор, бесконечно возвращающий одно и то же значение.
+    // Позволяет Insert(pos, count, value) пользоваться общим путём вставки диапазона
+    struct RepeatIterator {
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        reference operator*() const noexcept {
+            return *value;
+        }
+        RepeatIterator& operator++() noexcept {
+            return *this;
+        }
+        RepeatIterator operator++(int) noexcept {
+            return *this;
+        }
+        bool operator==(const RepeatIterator& other) const noexcept {
+            return value == other.value;
+        }
+        bool operator!=(const RepeatIterator& other) const noexcept {
+            return value != other.value;
+        }
+
+        const T* value;
+    };
+
+    // Вместимость, которую нужно выделить, чтобы разместить required элементов
+    VECTOR_CONSTEXPR size_t NextCapacity(size_t required) const noexcept {
+        return Growth::NextCapacity(Capacity(), required, sizeof(T));
+    }
+
+    // Вместимость для роста в EmplaceBack. Первое выделение берёт подсказку места создания,
+    // если подсказки включены и она больше обычного шага
+    VECTOR_CONSTEXPR size_t NextPushCapacity() const noexcept {
+        const size_t next = NextCapacity(size_ + 1);
+#ifdef VECTOR_ENABLE_PROFILING
+        if (Capacity() == 0 && site_ != nullptr && VectorProfiler::Instance().HintsEnabled()) {
+            return std::max(next, site_->CapacityHint());
+        }
+#endif
+        return next;
+    }
+
+    // Переносит элементы в новый буфер вместимостью new_capacity, оставляя свободной ячейку position,
+    // и создаёт в ней элемент из args. Аргументы могут ссылаться на элементы самого вектора,
+    // поэтому новый элемент конструируется до переноса старых
+    template <typename... Args>
+    VECTOR_CONSTEXPR void ReallocateAndEmplace(size_t new_capacity, size_t position, Args&&... args);
+
+    // Переносит элементы в new_data вокруг уже созданных в нём элементов [position, position + count)
+    // и делает new_data буфером вектора. При исключении разрушает созданные элементы, вектор не меняется
+    VECTOR_CONSTEXPR void RelocateAround(RawMemory<T, Alloc>& new_data, size_t position, size_t count);
+
+    // Вставляет count элементов однонаправленного диапазона, начинающегося с first
+    template <typename It>
+    void InsertForward(size_t position, It first, size_t count);
+
+    // Вставляет элемент из args в середину вектора, когда вместимости достаточно
+    template <typename... Args>
+    void EmplaceInMiddle(size_t position, Args&&... args);
+
+    // Сдвигает элементы [position, size_) на одну позицию вправо. Ячейка position остаётся
+    // с перемещённым объектом, которому нужно присвоить новое значение
+    void ShiftTailRight(size_t position) {
+        T* const data = data_.GetAddress();
+        new (data + size_) T(std::move(data[size_ - 1]));
+        ++size_;
+        std::move_backward(data + position, data + size_ - 2, data + size_ - 1);
+    }
+
+    // Истина, если единственный аргумент имеет тип T и не является элементом этого вектора.
+    // Такой аргумент остаётся корректным после сдвига хвоста
+    template <typename... Args>
+    bool IsExternalValue(const Args&... args) const noexcept {
+        if constexpr (sizeof...(Args) == 1 && (... && std::is_same_v<std::decay_t<Args>, T>)) {
+            const std::less<const T*> less;
+            const T* const data = data_.GetAddress();
+            return (... && (less(std::addressof(args), data) || !less(std::addressof(args), data + size_)));
+        }
+        else {
+            return false;
+        }
+    }
 
     // Вызывает деструкторы n объектов массива по адресу buf
     static void DestroyN(T* buf, size_t n) noexcept {
@@ -274,106 +1445,448 @@ private:
     }
 };
 
-template <typename T>
-template <typename Type>
-void Vector<T>::PushBack(Type&& value) {
-    if (Capacity() <= size_) {
+#ifdef VECTOR_DEBUG_ITERATORS
+// Итератор, запоминающий вектор и поколение его буфера. Каждое обращение проверяет, что буфер
+// не был заменён, а разыменование - ещё и что элемент лежит в [begin(), end()).
+// Неявно приводится к указателю, поэтому передаётся в функции, принимающие T*
+template <typename T, typename Alloc, typename Growth>
+template <bool IsConst>
+class Vector<T, Alloc, Growth>::CheckedIterator {
+    using Owner = std::conditional_t<IsConst, const Vector, Vector>;
 
-        RawMemory<T> new_data(size_ == 0 ? 1 : size_ * 2);
+    template <typename I>
+    using EnableIfIntegral = std::enable_if_t<std::is_integral_v<I>, int>;
 
-        new (new_data.GetAddress() + size_) T(std::forward<Type>(value));
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<IsConst, const T*, T*>;
+    using reference = std::conditional_t<IsConst, const T&, T&>;
+
+    CheckedIterator() = default;
+
+    VECTOR_CONSTEXPR CheckedIterator(Owner* owner, pointer ptr) noexcept
+        : owner_(owner)
+        , ptr_(ptr)
+        , generation_(owner->data_.Generation()) {
+    }
 
-        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
-            std::uninitialized_move_n(data_.GetAddress(), size_, new_data.GetAddress());
-        }
-        else {
-            std::uninitialized_copy_n(data_.GetAddress(), size_, new_data.GetAddress());
-        }
+    template <bool OtherConst, typename = std::enable_if_t<IsConst && !OtherConst>>
+    VECTOR_CONSTEXPR CheckedIterator(const CheckedIterator<OtherConst>& other) noexcept
+        : owner_(other.owner_)
+        , ptr_(other.ptr_)
+        , generation_(other.generation_) {
+    }
 
-        std::destroy_n(data_.GetAddress(), size_);
-        data_.Swap(new_data);
+    VECTOR_CONSTEXPR operator pointer() const noexcept {
+        CheckValid();
+        return ptr_;
+    }
 
+    VECTOR_CONSTEXPR reference operator*() const noexcept {
+        CheckValid();
+        VECTOR_CHECK(Index() < static_cast<difference_type>(owner_->size_) && "dereferencing end()");
+        return *ptr_;
     }
-    else {
-        new (data_.GetAddress() + size_) T(std::forward<Type>(value));
+    VECTOR_CONSTEXPR pointer operator->() const noexcept {
+        return std::addressof(**this);
+    }
+    template <typename I, EnableIfIntegral<I> = 0>
+    VECTOR_CONSTEXPR reference operator[](I offset) const noexcept {
+        return *(*this + offset);
     }
 
-    size_++;
-}
+    VECTOR_CONSTEXPR CheckedIterator& operator+=(difference_type offset) noexcept {
+        CheckValid();
+        const difference_type index = Index() + offset;
+        VECTOR_CHECK(index >= 0 && index <= static_cast<difference_type>(owner_->size_) && "iterator out of range");
+        ptr_ = owner_->data_.GetAddress() + index;
+        return *this;
+    }
+    VECTOR_CONSTEXPR CheckedIterator& operator-=(difference_type offset) noexcept {
+        return *this += -offset;
+    }
+    VECTOR_CONSTEXPR CheckedIterator& operator++() noexcept {
+        return *this += 1;
+    }
+    VECTOR_CONSTEXPR CheckedIterator operator++(int) noexcept {
+        CheckedIterator copy = *this;
+        ++*this;
+        return copy;
+    }
+    VECTOR_CONSTEXPR CheckedIterator& operator--() noexcept {
+        return *this -= 1;
+    }
+    VECTOR_CONSTEXPR CheckedIterator operator--(int) noexcept {
+        CheckedIterator copy = *this;
+        --*this;
+        return copy;
+    }
 
-template <typename T>
-template <typename... Args>
-T& Vector<T>::EmplaceBack(Args&&... args) {
-    if (Capacity() <= size_) {
+    // Смещение - шаблон, чтобы it + 1 не был неоднозначен со встроенным сложением указателя и int
+    template <typename I, EnableIfIntegral<I> = 0>
+    friend VECTOR_CONSTEXPR CheckedIterator operator+(CheckedIterator it, I offset) noexcept {
+        return it += static_cast<difference_type>(offset);
+    }
+    template <typename I, EnableIfIntegral<I> = 0>
+    friend VECTOR_CONSTEXPR CheckedIterator operator+(I offset, CheckedIterator it) noexcept {
+        return it += static_cast<difference_type>(offset);
+    }
+    template <typename I, EnableIfIntegral<I> = 0>
+    friend VECTOR_CONSTEXPR CheckedIterator operator-(CheckedIterator it, I offset) noexcept {
+        return it -= static_cast<difference_type>(offset);
+    }
+
+    friend VECTOR_CONSTEXPR difference_type operator-(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept {
+        CheckComparable(lhs, rhs);
+        return lhs.ptr_ - rhs.ptr_;
+    }
+
+    friend VECTOR_CONSTEXPR bool operator==(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept {
+        CheckComparable(lhs, rhs);
+        return lhs.ptr_ == rhs.ptr_;
+    }
+    friend VECTOR_CONSTEXPR bool operator!=(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept {
+        return !(lhs == rhs);
+    }
+    friend VECTOR_CONSTEXPR bool operator<(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept {
+        CheckComparable(lhs, rhs);
+        return lhs.ptr_ < rhs.ptr_;
+    }
+    friend VECTOR_CONSTEXPR bool operator>(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept {
+        return rhs < lhs;
+    }
+    friend VECTOR_CONSTEXPR bool operator<=(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept {
+        return !(rhs < lhs);
+    }
+    friend VECTOR_CONSTEXPR bool operator>=(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept {
+        return !(lhs < rhs);
+    }
 
-        RawMemory<T> new_data(size_ == 0 ? 1 : size_ * 2);
+private:
+    template <bool>
+    friend class CheckedIterator;
+
+    Owner* owner_ = nullptr;
+    pointer ptr_ = nullptr;
+    uint64_t generation_ = 0;
 
-        new (new_data.GetAddress() + size_) T(std::forward<Args>(args)...);
+    // Итератор по умолчанию ни к чему не привязан и годится только для сравнения и присваивания
+    VECTOR_CONSTEXPR void CheckValid() const noexcept {
+        VECTOR_CHECK((owner_ == nullptr || generation_ == owner_->data_.Generation())
+                     && "iterator invalidated by reallocation");
+    }
 
-        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
-            std::uninitialized_move_n(data_.GetAddress(), size_, new_data.GetAddress());
+    VECTOR_CONSTEXPR difference_type Index() const noexcept {
+        VECTOR_CHECK(owner_ != nullptr && "singular iterator");
+        return ptr_ - owner_->data_.GetAddress();
+    }
+
+    static VECTOR_CONSTEXPR void CheckComparable(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept {
+        VECTOR_CHECK(lhs.owner_ == rhs.owner_ && "iterators of different vectors");
+        lhs.CheckValid();
+        rhs.CheckValid();
+    }
+};
+#endif
+
+template <typename T, typename Alloc, typename Growth>
+template <typename... Args>
+VECTOR_CONSTEXPR void Vector<T, Alloc, Growth>::ReallocateAndEmplace(size_t new_capacity, size_t position, Args&&... args) {
+    VECTOR_PROFILE_REALLOCATION();
+    if constexpr (RawMemory<T, Alloc>::CAN_REALLOCATE) {
+        // При reallocate буфер может переехать вместе с элементами, на которые ссылаются args,
+        // поэтому значение создаётся заранее во временной ячейке и затем переносится побайтово
+        alignas(T) unsigned char slot[sizeof(T)];
+        T* value = new (slot) T(std::forward<Args>(args)...);
+        T* dst = nullptr;
+
+        if (data_.TryReallocate(new_capacity)) {
+            dst = data_.GetAddress() + position;
+            std::memmove(static_cast<void*>(dst + 1), static_cast<const void*>(dst), (size_ - position) * sizeof(T));
         }
         else {
-            std::uninitialized_copy_n(data_.GetAddress(), size_, new_data.GetAddress());
+            RawMemory<T, Alloc> new_data(data_.GetAllocator());
+            try {
+                new_data = RawMemory<T, Alloc>(new_capacity, data_.GetAllocator());
+            }
+            catch (...) {
+                std::destroy_at(value);
+                throw;
+            }
+            dst = new_data.GetAddress() + position;
+            RelocateN(data_.GetAddress(), position, new_data.GetAddress());
+            RelocateN(data_.GetAddress() + position, size_ - position, dst + 1);
+            if (Capacity() != 0) {
+                VECTOR_RECORD_STATS(T, OnRelocate(size_));
+            }
+            data_.Swap(new_data);
         }
+        RelocateN(value, 1, dst);
+        return;
+    }
 
-        std::destroy_n(data_.GetAddress(), size_);
-        data_.Swap(new_data);
+    RawMemory<T, Alloc> new_data(new_capacity, data_.GetAllocator());
+    ConstructAt(new_data.GetAddress() + position, std::forward<Args>(args)...);
+    RelocateAround(new_data, position, 1);
+}
+
+template <typename T, typename Alloc, typename Growth>
+VECTOR_CONSTEXPR void Vector<T, Alloc, Growth>::RelocateAround(RawMemory<T, Alloc>& new_data, size_t position, size_t count) {
+    T* gap = new_data.GetAddress() + position;
 
+    if constexpr (IsTriviallyRelocatableV<T>) {
+        RelocateN(data_.GetAddress(), position, new_data.GetAddress());
+        RelocateN(data_.GetAddress() + position, size_ - position, gap + count);
     }
     else {
-        new (data_.GetAddress() + size_) T(std::forward<Args>(args)...);
+        // Старые элементы разрушаются только после успешного создания всех копий,
+        // чтобы исключение при копировании оставило вектор нетронутым
+        try {
+            UninitializedMoveOrCopyN(data_.GetAddress(), position, new_data.GetAddress());
+            try {
+                UninitializedMoveOrCopyN(data_.GetAddress() + position, size_ - position, gap + count);
+            }
+            catch (...) {
+                std::destroy_n(new_data.GetAddress(), position);
+                throw;
+            }
+        }
+        catch (...) {
+            std::destroy_n(gap, count);
+            throw;
+        }
+        std::destroy_n(data_.GetAddress(), size_);
     }
 
-    return data_[size_++];
+    if (Capacity() != 0) {
+        VECTOR_RECORD_STATS(T, OnRelocate(size_));
+    }
+    data_.Swap(new_data);
 }
 
-template <typename T>
-template <typename... Args>
-typename Vector<T>::iterator Vector<T>::Emplace(const_iterator pos, Args&&... args) {
-    int position = pos - begin();
+template <typename T, typename Alloc, typename Growth>
+template <typename It>
+void Vector<T, Alloc, Growth>::InsertForward(size_t position, It first, size_t count) {
+    if (count == 0) {
+        return;
+    }
+    if (size_ + count > Capacity() && !data_.TryExpand(NextCapacity(size_ + count))) {
+        VECTOR_PROFILE_REALLOCATION();
+        const size_t new_capacity = NextCapacity(size_ + count);
+        if (!data_.TryReallocate(new_capacity)) {
+            // Новые элементы создаются в новом буфере до переноса старых:
+            // при исключении вектор остаётся нетронутым
+            RawMemory<T, Alloc> new_data(new_capacity, data_.GetAllocator());
+            UninitializedCopyN(first, count, new_data.GetAddress() + position);
+            RelocateAround(new_data, position, count);
+            size_ += count;
+            return;
+        }
+    }
 
-    if (Capacity() <= size_) {
+    T* gap = data_.GetAddress() + position;
+    const size_t tail = size_ - position;
+
+    if constexpr (IsTriviallyRelocatableV<T>) {
+        std::memmove(static_cast<void*>(gap + count), static_cast<const void*>(gap), tail * sizeof(T));
+        try {
+            UninitializedCopyN(first, count, gap);
+        }
+        catch (...) {
+            std::memmove(static_cast<void*>(gap), static_cast<const void*>(gap + count), tail * sizeof(T));
+            throw;
+        }
+        size_ += count;
+    }
+    else if (tail > count) {
+        // Последние count элементов переезжают в неинициализированную память за концом,
+        // остальная часть хвоста сдвигается присваиванием, а вставляемые значения присваиваются на место
+        T* const old_end = data_.GetAddress() + size_;
+        std::uninitialized_move_n(old_end - count, count, old_end);
+        size_ += count;
+        std::move_backward(gap, gap + tail - count, gap + tail);
+        std::copy_n(first, count, gap);
+    }
+    else {
+        // Хвост целиком уезжает за область вставки, часть новых значений сразу конструируется за концом
+        It mid = std::next(first, tail);
+        T* const old_end = data_.GetAddress() + size_;
+        UninitializedCopyN(mid, count - tail, old_end);
+        try {
+            std::uninitialized_move_n(gap, tail, gap + count);
+        }
+        catch (...) {
+            std::destroy_n(old_end, count - tail);
+            throw;
+        }
+        size_ += count;
+        std::copy_n(first, tail, gap);
+    }
+}
 
-        RawMemory<T> new_data(size_ == 0 ? 1 : size_ * 2);
+template <typename T, typename Alloc, typename Growth>
+template <typename It, typename>
+typename Vector<T, Alloc, Growth>::iterator Vector<T, Alloc, Growth>::Insert(const_iterator pos, It first, It last) {
+    const size_t position = PositionOf(pos);
+    AnnotationScope annotation(*this);
 
-        new (new_data.GetAddress() + position) T(std::forward<Args>(args)...);
+    if constexpr (std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<It>::iterator_category>) {
+        InsertForward(position, first, static_cast<size_t>(std::distance(first, last)));
+    }
+    else if (position == size_) {
+        for (; first != last; ++first) {
+            EmplaceBack(*first);
+        }
+    }
+    else {
+        // Длину однопроходного диапазона заранее не узнать: сначала собираем его целиком
+        Vector buffer(data_.GetAllocator());
+        for (; first != last; ++first) {
+            buffer.EmplaceBack(*first);
+        }
+        InsertForward(position, std::make_move_iterator(buffer.data_.GetAddress()), buffer.Size());
+    }
+    return begin() + position;
+}
 
-        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
-            std::uninitialized_move_n(data_.GetAddress(), position, new_data.GetAddress());
-            std::uninitialized_move_n(data_.GetAddress() + position, size_ - position, new_data.GetAddress() + position + 1);
+template <typename T, typename Alloc, typename Growth>
+typename Vector<T, Alloc, Growth>::iterator Vector<T, Alloc, Growth>::Insert(const_iterator pos, size_t count, const T& value) {
+    const size_t position = PositionOf(pos);
+    if (count == 0) {
+        return begin() + position;
+    }
+    // value может ссылаться на элемент, который будет сдвинут или перенесён
+    const T copy(value);
+    AnnotationScope annotation(*this);
+    InsertForward(position, RepeatIterator{ &copy }, count);
+    return begin() + position;
+}
 
+template <typename T, typename Alloc, typename Growth>
+template <typename It, typename>
+VECTOR_CONSTEXPR void Vector<T, Alloc, Growth>::Assign(It first, It last) {
+    AnnotationScope annotation(*this);
+    if constexpr (std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<It>::iterator_category>) {
+        const size_t count = static_cast<size_t>(std::distance(first, last));
+        if (count > Capacity()) {
+            RawMemory<T, Alloc> new_data(count, data_.GetAllocator());
+            UninitializedCopyN(first, count, new_data.GetAddress());
+            std::destroy_n(data_.GetAddress(), size_);
+            data_.Swap(new_data);
+            size_ = count;
+        }
+        else if (size_ <= count) {
+            It mid = std::next(first, size_);
+            std::copy(first, mid, data_.GetAddress());
+            UninitializedCopyN(mid, count - size_, data_.GetAddress() + size_);
+            size_ = count;
         }
         else {
-            std::uninitialized_copy_n(data_.GetAddress(), position, new_data.GetAddress());
-            std::uninitialized_copy_n(data_.GetAddress() + position, size_ - position, new_data.GetAddress() + position + 1);
+            std::copy(first, last, data_.GetAddress());
+            std::destroy_n(data_.GetAddress() + count, size_ - count);
+            size_ = count;
         }
-
+    }
+    else {
         std::destroy_n(data_.GetAddress(), size_);
-        data_.Swap(new_data);
+        size_ = 0;
+        for (; first != last; ++first) {
+            EmplaceBack(*first);
+        }
+    }
+}
+
+template <typename T, typename Alloc, typename Growth>
+template <typename Type>
+VECTOR_CONSTEXPR void Vector<T, Alloc, Growth>::PushBack(Type&& value) {
+    EmplaceBack(std::forward<Type>(value));
+}
 
+template <typename T, typename Alloc, typename Growth>
+template <typename... Args>
+VECTOR_CONSTEXPR T& Vector<T, Alloc, Growth>::EmplaceBack(Args&&... args) {
+    AnnotationScope annotation(*this);
+    if (Capacity() <= size_ && !data_.TryExpand(NextCapacity(size_ + 1))) {
+        ReallocateAndEmplace(NextPushCapacity(), size_, std::forward<Args>(args)...);
     }
     else {
-        try {
-            if (pos != end()) {
+        ConstructAt(data_.GetAddress() + size_, std::forward<Args>(args)...);
+    }
 
-                T new_s(std::forward<Args>(args)...);
-                new (end()) T(std::forward<T>(data_[size_ - 1]));
+    return data_[size_++];
+}
 
-                std::move_backward(begin() + position, end() - 1, end());
-                *(begin() + position) = std::forward<T>(new_s);
+template <typename T, typename Alloc, typename Growth>
+template <typename... Args>
+typename Vector<T, Alloc, Growth>::iterator Vector<T, Alloc, Growth>::Emplace(const_iterator pos, Args&&... args) {
+    const size_t position = PositionOf(pos);
+    AnnotationScope annotation(*this);
+
+    if (Capacity() <= size_ && !data_.TryExpand(NextCapacity(size_ + 1))) {
+        ReallocateAndEmplace(NextCapacity(size_ + 1), position, std::forward<Args>(args)...);
+        ++size_;
+    }
+    else if (position == size_) {
+        new (data_.GetAddress() + size_) T(std::forward<Args>(args)...);
+        ++size_;
+    }
+    else {
+        EmplaceInMiddle(position, std::forward<Args>(args)...);
+    }
+    return begin() + position;
+}
 
+template <typename T, typename Alloc, typename Growth>
+template <typename... Args>
+void Vector<T, Alloc, Growth>::EmplaceInMiddle(size_t position, Args&&... args) {
+    T* const hole = data_.GetAddress() + position;
+    const size_t tail = size_ - position;
+
+    if constexpr (IsTriviallyRelocatableV<T>) {
+        if (IsExternalValue(args...)) {
+            // Аргумент не лежит в сдвигаемой части: элемент создаётся сразу на своём месте,
+            // а при исключении хвост возвращается обратно
+            std::memmove(static_cast<void*>(hole + 1), static_cast<const void*>(hole), tail * sizeof(T));
+            try {
+                new (hole) T(std::forward<Args>(args)...);
             }
-            else {
-                new (end()) T(std::forward<Args>(args)...);
+            catch (...) {
+                std::memmove(static_cast<void*>(hole), static_cast<const void*>(hole + 1), tail * sizeof(T));
+                throw;
             }
-
         }
-        catch (...) {
-            operator delete (end());
-            throw;
+        else {
+            // Аргументы могут ссылаться на сдвигаемые элементы: значение создаётся заранее
+            // во временной ячейке и переносится побайтово, после чего исключения невозможны
+            alignas(T) unsigned char slot[sizeof(T)];
+            T* value = new (slot) T(std::forward<Args>(args)...);
+            std::memmove(static_cast<void*>(hole + 1), static_cast<const void*>(hole), tail * sizeof(T));
+            RelocateN(value, 1, hole);
         }
+        ++size_;
     }
-    size_++;
-    return begin() + position;
-}
\ No newline at end of file
+    else {
+        constexpr bool IS_SINGLE_RVALUE = sizeof...(Args) == 1
+            && (... && (std::is_same_v<std::remove_reference_t<Args>, T> && !std::is_lvalue_reference_v<Args>));
+
+        if constexpr (IS_SINGLE_RVALUE && std::is_nothrow_move_assignable_v<T>) {
+            if (IsExternalValue(args...)) {
+                ShiftTailRight(position);
+                ((*hole = std::forward<Args>(args)), ...);
+                return;
+            }
+        }
+        // Значение создаётся до сдвига, поэтому исключение в конструкторе не меняет вектор.
+        // При небросающих перемещениях T вставка целиком даёт строгую гарантию
+        T value(std::forward<Args>(args)...);
+        ShiftTailRight(position);
+        *hole = std::move(value);
+    }
+}
+
+template <typename T, typename Alloc, typename Growth, typename Predicate>
+size_t EraseIf(Vector<T, Alloc, Growth>& vector, Predicate pred) {
+    return vector.RemoveIf(pred);
+}
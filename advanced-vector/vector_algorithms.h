@@ -0,0 +1,573 @@
+#pragma once
+
+#include "vector.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+// Векторизованные алгоритмы над элементами int32_t и float: simd::Find, Count, MinMax, Sum, Dot, Transform, Fill.
+// Функции принимают VectorView, поэтому подходят и Vector целиком (неявное приведение), и его участки.
+//
+// Ядра написаны один раз на векторных расширениях GCC/Clang (vector_size) и инстанцируются для каждой
+// ширины регистра в функциях с атрибутом target: SSE2 (или NEON на ARM) - 16 байт, AVX2 - 32, AVX-512 - 64.
+// Набор инструкций выбирается при первом вызове по возможностям процессора (__builtin_cpu_supports),
+// так что программа, собранная без -mavx2, всё равно использует AVX2 там, где он есть.
+// Ядра с одним входом сначала обрабатывают скалярно элементы до границы регистра и дальше читают
+// выровненными загрузками. У буфера, выровненного AlignedAllocator<T, 64>, пролога нет вовсе.
+//
+// Порядок сложений в Sum и Dot для float отличается от последовательного, поэтому результат может
+// отличаться от простого цикла в пределах ошибки округления. При NaN результат MinMax не определён
+
+enum class SimdLevel {
+    SCALAR,
+    // SSE2 на x86, NEON на ARM
+    VECTOR128,
+    AVX2,
+    AVX512,
+};
+
+template <typename T>
+struct MinMaxResult {
+    T min;
+    T max;
+};
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define VECTOR_SIMD_X86 1
+#endif
+
+#if defined(__GNUC__) && (defined(VECTOR_SIMD_X86) || defined(__ARM_NEON))
+#define VECTOR_SIMD_EXTENSIONS 1
+#endif
+
+namespace simd_detail {
+
+inline constexpr size_t NPOS = static_cast<size_t>(-1);
+
+// Тип суммы: целые суммируются в int64_t, чтобы не переполняться
+template <typename T>
+using SumType = std::conditional_t<std::is_integral_v<T>, int64_t, T>;
+
+// Скалярные версии. Используются без векторных расширений, а также для пролога и хвоста ядер
+struct Scalar {
+    template <typename T>
+    static size_t Find(const T* data, size_t n, T value) noexcept {
+        for (size_t i = 0; i < n; ++i) {
+            if (data[i] == value) {
+                return i;
+            }
+        }
+        return NPOS;
+    }
+
+    template <typename T>
+    static size_t Count(const T* data, size_t n, T value) noexcept {
+        size_t count = 0;
+        for (size_t i = 0; i < n; ++i) {
+            count += data[i] == value;
+        }
+        return count;
+    }
+
+    template <typename T>
+    static void MinMax(const T* data, size_t n, T& min, T& max) noexcept {
+        for (size_t i = 0; i < n; ++i) {
+            min = data[i] < min ? data[i] : min;
+            max = max < data[i] ? data[i] : max;
+        }
+    }
+
+    template <typename T>
+    static SumType<T> Sum(const T* data, size_t n) noexcept {
+        SumType<T> sum = 0;
+        for (size_t i = 0; i < n; ++i) {
+            sum += data[i];
+        }
+        return sum;
+    }
+
+    template <typename T>
+    static SumType<T> Dot(const T* a, const T* b, size_t n) noexcept {
+        SumType<T> sum = 0;
+        for (size_t i = 0; i < n; ++i) {
+            sum += static_cast<SumType<T>>(a[i]) * b[i];
+        }
+        return sum;
+    }
+
+    template <typename T>
+    static void Transform(const T* src, T* dst, size_t n, T mul, T add) noexcept {
+        for (size_t i = 0; i < n; ++i) {
+            dst[i] = Affine(src[i], mul, add);
+        }
+    }
+
+    template <typename T>
+    static void Fill(T* dst, size_t n, T value) noexcept {
+        for (size_t i = 0; i < n; ++i) {
+            dst[i] = value;
+        }
+    }
+
+    // Для целых умножение без знака: переполнение заворачивается так же, как в векторных ядрах
+    template <typename T>
+    static T Affine(T x, T mul, T add) noexcept {
+        if constexpr (std::is_integral_v<T>) {
+            using U = std::make_unsigned_t<T>;
+            return static_cast<T>(static_cast<U>(x) * static_cast<U>(mul) + static_cast<U>(add));
+        }
+        else {
+            return x * mul + add;
+        }
+    }
+};
+
+#ifdef VECTOR_SIMD_EXTENSIONS
+
+#define VECTOR_SIMD_INLINE inline __attribute__((always_inline))
+
+
+// Регистр из Bytes / sizeof(T) элементов
+template <typename T, size_t Bytes>
+struct VecOf {
+    typedef T type __attribute__((vector_size(Bytes)));
+};
+
+// Ядра не имеют атрибута target и встраиваются в функции уровней ниже, где и получают
+// нужный набор инструкций
+template <size_t Bytes>
+struct Kernels {
+    template <typename T>
+    using V = typename VecOf<T, Bytes>::type;
+
+    template <typename T>
+    static constexpr size_t WIDTH = Bytes / sizeof(T);
+
+    template <typename T>
+    static VECTOR_SIMD_INLINE bool IsAligned(const T* p) noexcept {
+        return reinterpret_cast<uintptr_t>(p) % Bytes == 0;
+    }
+
+    // Количество элементов до границы регистра, но не больше n
+    template <typename T>
+    static VECTOR_SIMD_INLINE size_t Prologue(const T* p, size_t n) noexcept {
+        size_t i = 0;
+        while (i < n && !IsAligned(p + i)) {
+            ++i;
+        }
+        return i;
+    }
+
+    // Регистры не передаются и не возвращаются по значению: вне функций с атрибутом target
+    // это меняло бы соглашение о вызовах
+    template <typename T>
+    static VECTOR_SIMD_INLINE const V<T>& LoadAligned(const T* p) noexcept {
+        return *reinterpret_cast<const V<T>*>(__builtin_assume_aligned(p, Bytes));
+    }
+
+    template <typename T>
+    static VECTOR_SIMD_INLINE void Load(const T* p, V<T>& v) noexcept {
+        std::memcpy(&v, p, Bytes);
+    }
+
+    // Есть ли в маске сравнения хотя бы один ненулевой элемент
+    template <typename Mask>
+    static VECTOR_SIMD_INLINE bool Any(const Mask& mask) noexcept {
+        uint64_t words[Bytes / 8];
+        std::memcpy(words, &mask, Bytes);
+        uint64_t any = 0;
+        for (size_t i = 0; i < Bytes / 8; ++i) {
+            any |= words[i];
+        }
+        return any != 0;
+    }
+
+    template <typename T>
+    static VECTOR_SIMD_INLINE size_t Find(const T* data, size_t n, T value) noexcept {
+        constexpr size_t W = WIDTH<T>;
+        const size_t head = Prologue(data, n);
+        if (const size_t found = Scalar::Find(data, head, value); found != NPOS) {
+            return found;
+        }
+        const V<T> needle = V<T>{} + value;
+        size_t i = head;
+        for (; i + 2 * W <= n; i += 2 * W) {
+            if (Any((LoadAligned(data + i) == needle) | (LoadAligned(data + i + W) == needle))) {
+                return i + Scalar::Find(data + i, 2 * W, value);
+            }
+        }
+        const size_t found = Scalar::Find(data + i, n - i, value);
+        return found == NPOS ? NPOS : i + found;
+    }
+
+    template <typename T>
+    static VECTOR_SIMD_INLINE size_t Count(const T* data, size_t n, T value) noexcept {
+        constexpr size_t W = WIDTH<T>;
+        // Счётчики в элементах регистра сбрасываются в общий итог раньше, чем могут переполниться
+        constexpr size_t FLUSH_BLOCKS = size_t{ 1 } << 30;
+        using Counters = decltype(V<T>{} == V<T>{});
+
+        const size_t head = Prologue(data, n);
+        size_t count = Scalar::Count(data, head, value);
+        const V<T> needle = V<T>{} + value;
+        size_t i = head;
+        while (i + W <= n) {
+            Counters counters{};
+            for (size_t blocks = 0; blocks < FLUSH_BLOCKS && i + W <= n; ++blocks, i += W) {
+                // Истинное сравнение даёт -1 в элементе маски
+                counters -= LoadAligned(data + i) == needle;
+            }
+            for (size_t lane = 0; lane < W; ++lane) {
+                count += static_cast<size_t>(counters[lane]);
+            }
+        }
+        return count + Scalar::Count(data + i, n - i, value);
+    }
+
+    template <typename T>
+    static VECTOR_SIMD_INLINE void MinMax(const T* data, size_t n, T& min, T& max) noexcept {
+        constexpr size_t W = WIDTH<T>;
+        const size_t head = Prologue(data, n);
+        Scalar::MinMax(data, head, min, max);
+        size_t i = head;
+        if (i + W <= n) {
+            V<T> vmin = V<T>{} + min;
+            V<T> vmax = V<T>{} + max;
+            for (; i + W <= n; i += W) {
+                const V<T> block = LoadAligned(data + i);
+                vmin = block < vmin ? block : vmin;
+                vmax = vmax < block ? block : vmax;
+            }
+            for (size_t lane = 0; lane < W; ++lane) {
+                min = vmin[lane] < min ? vmin[lane] : min;
+                max = max < vmax[lane] ? vmax[lane] : max;
+            }
+        }
+        Scalar::MinMax(data + i, n - i, min, max);
+    }
+
+    template <typename T>
+    static VECTOR_SIMD_INLINE SumType<T> Sum(const T* data, size_t n) noexcept {
+        constexpr size_t W = WIDTH<T>;
+        const size_t head = Prologue(data, n);
+        SumType<T> sum = Scalar::Sum(data, head);
+        size_t i = head;
+        if constexpr (std::is_integral_v<T>) {
+            // Расширение до 64 бит: регистр суммы вдвое шире входного
+            using Wide = typename VecOf<SumType<T>, Bytes * 2>::type;
+            Wide acc{};
+            for (; i + W <= n; i += W) {
+                acc += __builtin_convertvector(LoadAligned(data + i), Wide);
+            }
+            for (size_t lane = 0; lane < W; ++lane) {
+                sum += acc[lane];
+            }
+        }
+        else {
+            // Несколько независимых сумм скрывают задержку сложения
+            V<T> acc[4] = {};
+            for (; i + 4 * W <= n; i += 4 * W) {
+                for (size_t k = 0; k < 4; ++k) {
+                    acc[k] += LoadAligned(data + i + k * W);
+                }
+            }
+            for (; i + W <= n; i += W) {
+                acc[0] += LoadAligned(data + i);
+            }
+            const V<T> total = (acc[0] + acc[1]) + (acc[2] + acc[3]);
+            for (size_t lane = 0; lane < W; ++lane) {
+                sum += total[lane];
+            }
+        }
+        return sum + Scalar::Sum(data + i, n - i);
+    }
+
+    template <typename T>
+    static VECTOR_SIMD_INLINE SumType<T> Dot(const T* a, const T* b, size_t n) noexcept {
+        constexpr size_t W = WIDTH<T>;
+        const size_t head = Prologue(a, n);
+        SumType<T> sum = Scalar::Dot(a, b, head);
+        size_t i = head;
+        if constexpr (std::is_integral_v<T>) {
+            using Wide = typename VecOf<SumType<T>, Bytes * 2>::type;
+            Wide acc{};
+            for (; i + W <= n; i += W) {
+                V<T> y;
+                Load(b + i, y);
+                acc += __builtin_convertvector(LoadAligned(a + i), Wide) * __builtin_convertvector(y, Wide);
+            }
+            for (size_t lane = 0; lane < W; ++lane) {
+                sum += acc[lane];
+            }
+        }
+        else {
+            V<T> acc[4] = {};
+            for (; i + 4 * W <= n; i += 4 * W) {
+                for (size_t k = 0; k < 4; ++k) {
+                    V<T> y;
+                    Load(b + i + k * W, y);
+                    acc[k] += LoadAligned(a + i + k * W) * y;
+                }
+            }
+            for (; i + W <= n; i += W) {
+                V<T> y;
+                Load(b + i, y);
+                acc[0] += LoadAligned(a + i) * y;
+            }
+            const V<T> total = (acc[0] + acc[1]) + (acc[2] + acc[3]);
+            for (size_t lane = 0; lane < W; ++lane) {
+                sum += total[lane];
+            }
+        }
+        return sum + Scalar::Dot(a + i, b + i, n - i);
+    }
+
+    // Выравнивание выбирается по приёмнику: запись через границу кеш-линии дороже чтения
+    template <typename T>
+    static VECTOR_SIMD_INLINE void Transform(const T* src, T* dst, size_t n, T mul, T add) noexcept {
+        constexpr size_t W = WIDTH<T>;
+        const size_t head = Prologue(dst, n);
+        Scalar::Transform(src, dst, head, mul, add);
+        size_t i = head;
+        if constexpr (std::is_integral_v<T>) {
+            using U = std::make_unsigned_t<T>;
+            // Умножение без знака: переполнение знакового целого было бы неопределённым поведением
+            const V<U> vmul = V<U>{} + static_cast<U>(mul);
+            const V<U> vadd = V<U>{} + static_cast<U>(add);
+            for (; i + W <= n; i += W) {
+                V<U> x;
+                Load(reinterpret_cast<const U*>(src + i), x);
+                *reinterpret_cast<V<U>*>(reinterpret_cast<U*>(dst + i)) = x * vmul + vadd;
+            }
+        }
+        else {
+            const V<T> vmul = V<T>{} + mul;
+            const V<T> vadd = V<T>{} + add;
+            for (; i + W <= n; i += W) {
+                V<T> x;
+                Load(src + i, x);
+                *reinterpret_cast<V<T>*>(dst + i) = x * vmul + vadd;
+            }
+        }
+        Scalar::Transform(src + i, dst + i, n - i, mul, add);
+    }
+
+    template <typename T>
+    static VECTOR_SIMD_INLINE void Fill(T* dst, size_t n, T value) noexcept {
+        constexpr size_t W = WIDTH<T>;
+        const size_t head = Prologue(dst, n);
+        Scalar::Fill(dst, head, value);
+        const V<T> v = V<T>{} + value;
+        size_t i = head;
+        for (; i + W <= n; i += W) {
+            *reinterpret_cast<V<T>*>(dst + i) = v;
+        }
+        Scalar::Fill(dst + i, n - i, value);
+    }
+};
+
+// Точки входа одного уровня: ядра встраиваются в функции с атрибутом target
+#define VECTOR_SIMD_DEFINE_LEVEL(Name, Attributes, Bytes)                                         \
+    struct Name {                                                                                 \
+        template <typename T>                                                                     \
+        Attributes static size_t Find(const T* data, size_t n, T value) noexcept {                \
+            return Kernels<Bytes>::Find(data, n, value);                                          \
+        }                                                                                         \
+        template <typename T>                                                                     \
+        Attributes static size_t Count(const T* data, size_t n, T value) noexcept {               \
+            return Kernels<Bytes>::Count(data, n, value);                                         \
+        }                                                                                         \
+        template <typename T>                                                                     \
+        Attributes static void MinMax(const T* data, size_t n, T& min, T& max) noexcept {         \
+            Kernels<Bytes>::MinMax(data, n, min, max);                                            \
+        }                                                                                         \
+        template <typename T>                                                                     \
+        Attributes static SumType<T> Sum(const T* data, size_t n) noexcept {                      \
+            return Kernels<Bytes>::Sum(data, n);                                                  \
+        }                                                                                         \
+        template <typename T>                                                                     \
+        Attributes static SumType<T> Dot(const T* a, const T* b, size_t n) noexcept {             \
+            return Kernels<Bytes>::Dot(a, b, n);                                                  \
+        }                                                                                         \
+        template <typename T>                                                                     \
+        Attributes static void Transform(const T* src, T* dst, size_t n, T mul, T add) noexcept { \
+            Kernels<Bytes>::Transform(src, dst, n, mul, add);                                     \
+        }                                                                                         \
+        template <typename T>                                                                     \
+        Attributes static void Fill(T* dst, size_t n, T value) noexcept {                         \
+            Kernels<Bytes>::Fill(dst, n, value);                                                  \
+        }                                                                                         \
+    }
+
+#ifdef VECTOR_SIMD_X86
+VECTOR_SIMD_DEFINE_LEVEL(Vector128, __attribute__((target("sse2"))), 16);
+VECTOR_SIMD_DEFINE_LEVEL(Avx2, __attribute__((target("avx2"))), 32);
+VECTOR_SIMD_DEFINE_LEVEL(Avx512, __attribute__((target("avx512f"))), 64);
+#else
+// NEON входит в базовый набор AArch64 и не требует атрибута
+VECTOR_SIMD_DEFINE_LEVEL(Vector128, , 16);
+#endif
+
+#undef VECTOR_SIMD_DEFINE_LEVEL
+
+
+#endif  // VECTOR_SIMD_EXTENSIONS
+
+inline SimdLevel DetectSimdLevel() noexcept {
+#if defined(VECTOR_SIMD_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return SimdLevel::AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return SimdLevel::AVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return SimdLevel::VECTOR128;
+    }
+    return SimdLevel::SCALAR;
+#elif defined(VECTOR_SIMD_EXTENSIONS)
+    return SimdLevel::VECTOR128;
+#else
+    return SimdLevel::SCALAR;
+#endif
+}
+
+inline std::atomic<SimdLevel>& ActiveLevel() noexcept {
+    static std::atomic<SimdLevel> level{ DetectSimdLevel() };
+    return level;
+}
+
+// Вызывает f(Level{}) для выбранного уровня, где Level - структура с точками входа
+template <typename F>
+decltype(auto) Dispatch(F f) {
+    switch (ActiveLevel().load(std::memory_order_relaxed)) {
+#ifdef VECTOR_SIMD_X86
+    case SimdLevel::AVX512:
+        return f(Avx512{});
+    case SimdLevel::AVX2:
+        return f(Avx2{});
+#endif
+#ifdef VECTOR_SIMD_EXTENSIONS
+    case SimdLevel::VECTOR128:
+        return f(Vector128{});
+#endif
+    default:
+        return f(Scalar{});
+    }
+}
+
+template <typename T>
+MinMaxResult<T> MinMax(VectorView<const T> view) noexcept {
+    VECTOR_CHECK(!view.Empty());
+    MinMaxResult<T> result{ view[0], view[0] };
+    Dispatch([&](auto level) {
+        level.MinMax(view.Data(), view.Size(), result.min, result.max);
+    });
+    return result;
+}
+
+}  // namespace simd_detail
+
+// Уровень, который используют алгоритмы
+inline SimdLevel GetSimdLevel() noexcept {
+    return simd_detail::ActiveLevel().load(std::memory_order_relaxed);
+}
+
+// Ограничивает используемый набор инструкций, например для сравнения ядер в тестах.
+// Уровень выше поддерживаемого процессором понижается до поддерживаемого. Возвращает установленный
+inline SimdLevel SetSimdLevel(SimdLevel level) noexcept {
+    const SimdLevel supported = simd_detail::DetectSimdLevel();
+    if (level > supported) {
+        level = supported;
+    }
+    simd_detail::ActiveLevel().store(level, std::memory_order_relaxed);
+    return level;
+}
+
+namespace simd {
+
+// Индекс первого элемента, равного value, или VectorView<const T>::NPOS
+inline size_t Find(VectorView<const int32_t> view, int32_t value) noexcept {
+    return simd_detail::Dispatch([&](auto level) {
+        return level.Find(view.Data(), view.Size(), value);
+    });
+}
+inline size_t Find(VectorView<const float> view, float value) noexcept {
+    return simd_detail::Dispatch([&](auto level) {
+        return level.Find(view.Data(), view.Size(), value);
+    });
+}
+
+inline size_t Count(VectorView<const int32_t> view, int32_t value) noexcept {
+    return simd_detail::Dispatch([&](auto level) {
+        return level.Count(view.Data(), view.Size(), value);
+    });
+}
+inline size_t Count(VectorView<const float> view, float value) noexcept {
+    return simd_detail::Dispatch([&](auto level) {
+        return level.Count(view.Data(), view.Size(), value);
+    });
+}
+
+// Участок не должен быть пустым
+inline MinMaxResult<int32_t> MinMax(VectorView<const int32_t> view) noexcept {
+    return simd_detail::MinMax(view);
+}
+inline MinMaxResult<float> MinMax(VectorView<const float> view) noexcept {
+    return simd_detail::MinMax(view);
+}
+
+inline int64_t Sum(VectorView<const int32_t> view) noexcept {
+    return simd_detail::Dispatch([&](auto level) {
+        return level.Sum(view.Data(), view.Size());
+    });
+}
+inline float Sum(VectorView<const float> view) noexcept {
+    return simd_detail::Dispatch([&](auto level) {
+        return level.Sum(view.Data(), view.Size());
+    });
+}
+
+// Скалярное произведение участков одинаковой длины
+inline int64_t Dot(VectorView<const int32_t> a, VectorView<const int32_t> b) noexcept {
+    VECTOR_CHECK(a.Size() == b.Size());
+    return simd_detail::Dispatch([&](auto level) {
+        return level.Dot(a.Data(), b.Data(), a.Size());
+    });
+}
+inline float Dot(VectorView<const float> a, VectorView<const float> b) noexcept {
+    VECTOR_CHECK(a.Size() == b.Size());
+    return simd_detail::Dispatch([&](auto level) {
+        return level.Dot(a.Data(), b.Data(), a.Size());
+    });
+}
+
+// dst[i] = src[i] * mul + add. Участки одинаковой длины, совпадают целиком или не пересекаются.
+// Для int32_t переполнение заворачивается по модулю 2^32
+inline void Transform(VectorView<const int32_t> src, VectorView<int32_t> dst, int32_t mul, int32_t add) noexcept {
+    VECTOR_CHECK(src.Size() == dst.Size());
+    simd_detail::Dispatch([&](auto level) {
+        level.Transform(src.Data(), dst.Data(), src.Size(), mul, add);
+    });
+}
+inline void Transform(VectorView<const float> src, VectorView<float> dst, float mul, float add) noexcept {
+    VECTOR_CHECK(src.Size() == dst.Size());
+    simd_detail::Dispatch([&](auto level) {
+        level.Transform(src.Data(), dst.Data(), src.Size(), mul, add);
+    });
+}
+
+inline void Fill(VectorView<int32_t> dst, int32_t value) noexcept {
+    simd_detail::Dispatch([&](auto level) {
+        level.Fill(dst.Data(), dst.Size(), value);
+    });
+}
+inline void Fill(VectorView<float> dst, float value) noexcept {
+    simd_detail::Dispatch([&](auto level) {
+        level.Fill(dst.Data(), dst.Size(), value);
+    });
+}
+
+}  // namespace simd
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+
+// Усиленный режим (VECTOR_HARDENED) не зависит от NDEBUG и предназначен для рабочих сборок:
+// выход за границы в operator[], PopBack пустого вектора, позиции вне вектора в Insert и Erase
+// и неверные границы представлений из vector_view.h завершают процесс с сообщением.
+// Проверка - одно сравнение с заранее предсказанным переходом.
+// VECTOR_DEBUG_ITERATORS включает усиленный режим и заменяет итераторы Vector на проверяемые:
+// они помнят поколение буфера и обнаруживают использование после реаллокации.
+// В усиленном режиме под AddressSanitizer неиспользуемый хвост буфера размечается как недоступный
+#if defined(VECTOR_DEBUG_ITERATORS) && !defined(VECTOR_HARDENED)
+#define VECTOR_HARDENED
+#endif
+
+#ifdef VECTOR_HARDENED
+[[noreturn]] inline void VectorCheckFailed(const char* condition, const char* file, int line) noexcept {
+    std::fprintf(stderr, "%s:%d: vector check failed: %s\n", file, line, condition);
+    std::abort();
+}
+
+#define VECTOR_CHECK(condition) \
+    (__builtin_expect(static_cast<bool>(condition), 1) ? (void)0 : VectorCheckFailed(#condition, __FILE__, __LINE__))
+#else
+#define VECTOR_CHECK(condition) assert(condition)
+#endif
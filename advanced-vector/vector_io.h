@@ -0,0 +1,223 @@
+#pragma once
+
+#include "vector.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+#include <system_error>
+
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+// Двоичная запись и чтение Vector тривиально копируемых типов. Буфер передаётся целиком,
+// без обхода элементов: в файловый дескриптор - через writev/readv, в поток - одним write/read.
+// Перед данными пишется заголовок, по которому при чтении проверяется совместимость формата
+
+struct VectorIoHeader {
+    static constexpr uint32_t MAGIC = 0x31564441;  // "ADV1"
+    static constexpr uint16_t VERSION = 1;
+    static constexpr uint8_t LITTLE_ENDIAN_ORDER = 1;
+    static constexpr uint8_t BIG_ENDIAN_ORDER = 2;
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    static constexpr uint8_t HOST_ORDER = BIG_ENDIAN_ORDER;
+#else
+    static constexpr uint8_t HOST_ORDER = LITTLE_ENDIAN_ORDER;
+#endif
+
+    uint32_t magic = MAGIC;
+    uint16_t version = VERSION;
+    uint8_t byte_order = HOST_ORDER;
+    uint8_t reserved = 0;
+    uint32_t elem_size = 0;
+    uint32_t alignment = 0;
+    uint64_t count = 0;
+
+    template <typename T>
+    static VectorIoHeader For(size_t count) noexcept {
+        VectorIoHeader header;
+        header.elem_size = sizeof(T);
+        header.alignment = alignof(T);
+        header.count = count;
+        return header;
+    }
+
+    // Бросает std::runtime_error, если данные записаны для другого типа или платформы
+    template <typename T>
+    void Check() const {
+        if (magic != MAGIC || version != VERSION) {
+            throw std::runtime_error("not a serialized vector");
+        }
+        if (byte_order != HOST_ORDER) {
+            throw std::runtime_error("serialized vector has a different byte order");
+        }
+        if (elem_size != sizeof(T) || alignment != alignof(T)) {
+            throw std::runtime_error("serialized vector has a different element layout");
+        }
+    }
+};
+
+static_assert(sizeof(VectorIoHeader) == 24, "VectorIoHeader layout is part of the format");
+
+namespace vector_io_detail {
+
+// Передаёт все байты описанных iov участков, продолжая после частичных записей и чтений.
+// Массив iov изменяется
+template <bool Write>
+void TransferAll(int fd, iovec* iov, int count) {
+    while (count > 0) {
+        const ssize_t done = Write ? ::writev(fd, iov, count) : ::readv(fd, iov, count);
+        if (done < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::system_error(errno, std::generic_category(), Write ? "writev" : "readv");
+        }
+        if (done == 0 && !Write) {
+            throw std::runtime_error("unexpected end of serialized vector");
+        }
+        size_t left = static_cast<size_t>(done);
+        while (count > 0 && left >= iov->iov_len) {
+            left -= iov->iov_len;
+            ++iov;
+            --count;
+        }
+        if (count > 0) {
+            iov->iov_base = static_cast<char*>(iov->iov_base) + left;
+            iov->iov_len -= left;
+        }
+    }
+}
+
+// Сколько байт осталось до конца обычного файла. Для каналов, сокетов и устройств неизвестно
+inline std::optional<uint64_t> RemainingBytes(int fd) noexcept {
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        return std::nullopt;
+    }
+    const off_t position = ::lseek(fd, 0, SEEK_CUR);
+    if (position < 0) {
+        return std::nullopt;
+    }
+    return position < st.st_size ? static_cast<uint64_t>(st.st_size - position) : 0;
+}
+
+// Сколько байт осталось до конца потока, если он поддерживает позиционирование
+inline std::optional<uint64_t> RemainingBytes(std::istream& in) {
+    const std::istream::pos_type position = in.tellg();
+    if (position == std::istream::pos_type(-1) || !in.seekg(0, std::ios::end)) {
+        in.clear();
+        return std::nullopt;
+    }
+    const std::istream::pos_type end = in.tellg();
+    in.seekg(position);
+    if (end == std::istream::pos_type(-1) || !in) {
+        in.clear();
+        return std::nullopt;
+    }
+    return end > position ? static_cast<uint64_t>(end - position) : 0;
+}
+
+// Объём, который читается за один раз, когда длина входа неизвестна
+inline constexpr size_t READ_CHUNK_BYTES = size_t(1) << 20;
+
+// Читает header.count элементов функцией read(dst, bytes). Число элементов взято из входа и
+// не заслуживает доверия: оно сверяется с пределом аллокатора и с остатком входа, а если остаток
+// неизвестен, вектор растёт по мере чтения, и усечённый вход не вызывает огромного выделения памяти
+template <typename T, typename Alloc, typename Growth, typename Read>
+void ReadElements(Vector<T, Alloc, Growth>& v, uint64_t count, std::optional<uint64_t> remaining, Read read) {
+    const uint64_t max_count = std::min<uint64_t>(std::allocator_traits<Alloc>::max_size(v.GetAllocator()),
+                                                  std::numeric_limits<size_t>::max() / sizeof(T));
+    if (count > max_count) {
+        throw std::runtime_error("serialized vector is too large");
+    }
+    if (remaining && *remaining / sizeof(T) < count) {
+        throw std::runtime_error("unexpected end of serialized vector");
+    }
+    const size_t total = static_cast<size_t>(count);
+    if (remaining) {
+        v.Reserve(total);
+    }
+    const size_t chunk = std::max<size_t>(READ_CHUNK_BYTES / sizeof(T), 1);
+    try {
+        while (v.Size() < total) {
+            const size_t offset = v.Size();
+            const size_t n = std::min(chunk, total - offset);
+            if (v.Capacity() < offset + n) {
+                v.Reserve(std::min(total, std::max(offset + n, v.Capacity() * 2)));
+            }
+            v.ResizeUninitialized(offset + n);
+            read(v.View().Data() + offset, n * sizeof(T));
+        }
+    }
+    catch (...) {
+        v.Clear();
+        throw;
+    }
+}
+
+}  // namespace vector_io_detail
+
+// Записывает заголовок и элементы одним writev
+template <typename T, typename Alloc, typename Growth>
+void WriteTo(int fd, const Vector<T, Alloc, Growth>& v) {
+    static_assert(std::is_trivially_copyable_v<T>, "binary serialization requires a trivially copyable type");
+    VectorIoHeader header = VectorIoHeader::For<T>(v.Size());
+    iovec iov[2] = {
+        { &header, sizeof(header) },
+        { const_cast<T*>(v.View().Data()), v.Size() * sizeof(T) },
+    };
+    vector_io_detail::TransferAll<true>(fd, iov, v.Size() == 0 ? 1 : 2);
+}
+
+// Заменяет содержимое v прочитанными элементами. Данные читаются прямо в буфер вектора,
+// без инициализации элементов. При ошибке v остаётся пустым, а число элементов из заголовка
+// не приводит к выделению памяти сверх того, что реально есть во входе
+template <typename T, typename Alloc, typename Growth>
+void ReadFrom(int fd, Vector<T, Alloc, Growth>& v) {
+    static_assert(std::is_trivially_copyable_v<T>, "binary serialization requires a trivially copyable type");
+    v.Clear();
+    VectorIoHeader header;
+    iovec header_iov{ &header, sizeof(header) };
+    vector_io_detail::TransferAll<false>(fd, &header_iov, 1);
+    header.Check<T>();
+
+    vector_io_detail::ReadElements(v, header.count, vector_io_detail::RemainingBytes(fd), [fd](T* dst, size_t bytes) {
+        iovec data_iov{ dst, bytes };
+        vector_io_detail::TransferAll<false>(fd, &data_iov, 1);
+    });
+}
+
+template <typename T, typename Alloc, typename Growth>
+void WriteTo(std::ostream& out, const Vector<T, Alloc, Growth>& v) {
+    static_assert(std::is_trivially_copyable_v<T>, "binary serialization requires a trivially copyable type");
+    const VectorIoHeader header = VectorIoHeader::For<T>(v.Size());
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(v.View().Data()), static_cast<std::streamsize>(v.Size() * sizeof(T)));
+    if (!out) {
+        throw std::runtime_error("failed to write serialized vector");
+    }
+}
+
+template <typename T, typename Alloc, typename Growth>
+void ReadFrom(std::istream& in, Vector<T, Alloc, Growth>& v) {
+    static_assert(std::is_trivially_copyable_v<T>, "binary serialization requires a trivially copyable type");
+    v.Clear();
+    VectorIoHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        throw std::runtime_error("unexpected end of serialized vector");
+    }
+    header.Check<T>();
+
+    vector_io_detail::ReadElements(v, header.count, vector_io_detail::RemainingBytes(in), [&in](T* dst, size_t bytes) {
+        if (!in.read(reinterpret_cast<char*>(dst), static_cast<std::streamsize>(bytes))) {
+            throw std::runtime_error("unexpected end of serialized vector");
+        }
+    });
+}
@@ -0,0 +1,350 @@
+#pragma once
+
+// Профиль векторов по местам создания. Подключается из vector.h, только если определён макрос
+// VECTOR_ENABLE_PROFILING. Тогда каждый конструктор Vector, кроме перемещающего, принимает
+// последним аргументом по умолчанию место вызова, и вектор относит к нему свои события:
+// распределение размеров перед разрушением, число реаллокаций и время, потраченное на них.
+//
+// Место определяется файлом, строкой, столбцом и размером элемента, поэтому вектор, созданный
+// в шаблоне, учитывается отдельно для элементов разного размера. Векторы, созданные внутри
+// других контейнеров библиотеки, относятся к строке в их заголовке.
+//
+// По накопленному распределению для места вычисляется подсказка вместимости. Если подсказки
+// включены (VectorProfiler::EnableHints), первый рост через PushBack и EmplaceBack сразу выделяет
+// её, и большинство векторов места обходится одним выделением вместо цепочки удвоений
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <ostream>
+#include <vector>
+
+#if __cplusplus >= 202002L && __has_include(<source_location>)
+#include <source_location>
+#endif
+
+struct VectorSourceLocation {
+    const char* file = "";
+    const char* function = "";
+    uint_least32_t line = 0;
+    uint_least32_t column = 0;
+
+    // Место вызова, если Current() вызвана прямо в аргументе по умолчанию: встроенные функции
+    // в аргументах по умолчанию самой Current() вычисляются в точке вызова той функции.
+    // До C++20 - встроенные функции GCC и Clang (столбец GCC не сообщает)
+#if defined(__cpp_lib_source_location)
+    static constexpr VectorSourceLocation Current(
+        const std::source_location& location = std::source_location::current()) noexcept {
+        return VectorSourceLocation{ location.file_name(), location.function_name(), location.line(),
+                                     location.column() };
+    }
+#else
+    static constexpr VectorSourceLocation Current(const char* file = __builtin_FILE(),
+                                                  const char* function = __builtin_FUNCTION(),
+                                                  uint_least32_t line = __builtin_LINE(),
+#if defined(__clang__)
+                                                  uint_least32_t column = __builtin_COLUMN()
+#else
+                                                  uint_least32_t column = 0
+#endif
+                                                      ) noexcept {
+        return VectorSourceLocation{ file, function, line, column };
+    }
+#endif
+};
+
+// Счётчики одного места создания. Обновляются атомарно из любых потоков
+class VectorProfileSite {
+public:
+    // Размеры перед разрушением по корзинам: 0, 1, [2, 3], [4, 7], ..., последняя - от 2^(N-2)
+    static constexpr size_t SIZE_BUCKETS = 34;
+    // Подсказка покрывает такую долю векторов места
+    static constexpr size_t HINT_PERCENTILE = 90;
+    // Подсказка появляется после стольких разрушенных векторов и пересчитывается с тем же шагом
+    static constexpr size_t HINT_MIN_SAMPLES = 32;
+    // Подсказка не выделяет больше этого объёма
+    static constexpr size_t MAX_HINT_BYTES = 1024 * 1024;
+
+    // Неатомарный снимок счётчиков
+    struct Snapshot {
+        size_t vectors = 0;
+        size_t destroyed = 0;
+        size_t reallocations = 0;
+        uint64_t reallocation_ns = 0;
+        size_t elements_relocated = 0;
+        size_t max_size = 0;
+        size_t capacity_hint = 0;
+        std::array<size_t, SIZE_BUCKETS> size_histogram{};
+    };
+
+    VectorProfileSite(const VectorSourceLocation& location, size_t elem_size) noexcept
+        : location(location)
+        , elem_size(elem_size) {
+    }
+
+    void OnConstruct() noexcept {
+        vectors_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Буфер заменён новым или перенесён через reallocate. Рост на месте не учитывается
+    void OnReallocate(size_t relocated, uint64_t nanoseconds) noexcept {
+        reallocations_.fetch_add(1, std::memory_order_relaxed);
+        reallocation_ns_.fetch_add(nanoseconds, std::memory_order_relaxed);
+        elements_relocated_.fetch_add(relocated, std::memory_order_relaxed);
+    }
+
+    // Учитываются только векторы, владеющие буфером: перемещённые и ни разу не выделявшие
+    // память ничего не говорят о нужной вместимости
+    void OnDestroy(size_t size, size_t capacity) noexcept {
+        if (capacity == 0) {
+            return;
+        }
+        size_histogram_[BucketOf(size)].fetch_add(1, std::memory_order_relaxed);
+        size_t max_size = max_size_.load(std::memory_order_relaxed);
+        while (max_size < size && !max_size_.compare_exchange_weak(max_size, size, std::memory_order_relaxed)) {
+        }
+        if ((destroyed_.fetch_add(1, std::memory_order_relaxed) + 1) % HINT_MIN_SAMPLES == 0) {
+            capacity_hint_.store(ComputeHint(), std::memory_order_relaxed);
+        }
+    }
+
+    // Вместимость первого выделения для векторов этого места или 0, если данных пока мало
+    size_t CapacityHint() const noexcept {
+        return capacity_hint_.load(std::memory_order_relaxed);
+    }
+
+    Snapshot Read() const noexcept {
+        Snapshot snapshot;
+        snapshot.vectors = vectors_.load(std::memory_order_relaxed);
+        snapshot.destroyed = destroyed_.load(std::memory_order_relaxed);
+        snapshot.reallocations = reallocations_.load(std::memory_order_relaxed);
+        snapshot.reallocation_ns = reallocation_ns_.load(std::memory_order_relaxed);
+        snapshot.elements_relocated = elements_relocated_.load(std::memory_order_relaxed);
+        snapshot.max_size = max_size_.load(std::memory_order_relaxed);
+        snapshot.capacity_hint = CapacityHint();
+        for (size_t i = 0; i < SIZE_BUCKETS; ++i) {
+            snapshot.size_histogram[i] = size_histogram_[i].load(std::memory_order_relaxed);
+        }
+        return snapshot;
+    }
+
+    void Reset() noexcept {
+        vectors_ = 0;
+        destroyed_ = 0;
+        reallocations_ = 0;
+        reallocation_ns_ = 0;
+        elements_relocated_ = 0;
+        max_size_ = 0;
+        capacity_hint_ = 0;
+        for (auto& bucket : size_histogram_) {
+            bucket = 0;
+        }
+    }
+
+    bool Matches(const VectorSourceLocation& other, size_t other_elem_size) const noexcept {
+        return location.line == other.line && location.column == other.column && elem_size == other_elem_size
+               && (location.file == other.file || std::strcmp(location.file, other.file) == 0);
+    }
+
+    const VectorSourceLocation location;
+    const size_t elem_size;
+
+private:
+    std::atomic<size_t> vectors_{ 0 };
+    std::atomic<size_t> destroyed_{ 0 };
+    std::atomic<size_t> reallocations_{ 0 };
+    std::atomic<uint64_t> reallocation_ns_{ 0 };
+    std::atomic<size_t> elements_relocated_{ 0 };
+    std::atomic<size_t> max_size_{ 0 };
+    std::atomic<size_t> capacity_hint_{ 0 };
+    std::array<std::atomic<size_t>, SIZE_BUCKETS> size_histogram_{};
+
+    static size_t BucketOf(size_t size) noexcept {
+        size_t bucket = 0;
+        while (size != 0 && bucket + 1 < SIZE_BUCKETS) {
+            size >>= 1;
+            ++bucket;
+        }
+        return bucket;
+    }
+
+    // Верхняя граница корзины, в которую попадает HINT_PERCENTILE процентов векторов,
+    // но не больше наибольшего встреченного размера: векторам одного размера хватает ровно его
+    size_t ComputeHint() const noexcept {
+        std::array<size_t, SIZE_BUCKETS> counts;
+        size_t total = 0;
+        for (size_t i = 0; i < SIZE_BUCKETS; ++i) {
+            counts[i] = size_histogram_[i].load(std::memory_order_relaxed);
+            total += counts[i];
+        }
+        const size_t needed = (total * HINT_PERCENTILE + 99) / 100;
+        size_t covered = 0;
+        size_t bucket = 0;
+        for (; bucket + 1 < SIZE_BUCKETS; ++bucket) {
+            covered += counts[bucket];
+            if (covered >= needed) {
+                break;
+            }
+        }
+        const size_t upper = bucket == 0 ? 0 : (size_t{ 1 } << bucket) - 1;
+        return std::min({ upper, max_size_.load(std::memory_order_relaxed), MAX_HINT_BYTES / elem_size });
+    }
+};
+
+// Реестр мест создания. Поиск места при создании вектора не берёт блокировок: места хранятся
+// в открытой хеш-таблице фиксированного размера и никогда не удаляются. Когда таблица заполнена,
+// новые места учитываются в общем месте "<other>"
+class VectorProfiler {
+public:
+    static constexpr size_t MAX_SITES = 4096;
+
+    static VectorProfiler& Instance() noexcept {
+        // Не разрушается: векторы могут разрушаться в деструкторах статических объектов
+        static VectorProfiler* profiler = new VectorProfiler();
+        return *profiler;
+    }
+
+    // Место для вектора с элементами размера elem_size, созданного в location, или nullptr,
+    // если не хватило памяти
+    VectorProfileSite* SiteFor(const VectorSourceLocation& location, size_t elem_size) noexcept {
+        const size_t hash = Hash(location, elem_size);
+        for (size_t probe = 0; probe < MAX_SITES; ++probe) {
+            std::atomic<VectorProfileSite*>& slot = slots_[(hash + probe) % MAX_SITES];
+            VectorProfileSite* site = slot.load(std::memory_order_acquire);
+            if (site == nullptr) {
+                auto* created = new (std::nothrow) VectorProfileSite(location, elem_size);
+                if (created == nullptr) {
+                    return nullptr;
+                }
+                if (slot.compare_exchange_strong(site, created, std::memory_order_acq_rel)) {
+                    return created;
+                }
+                // Слот занял другой поток, возможно - тем же местом
+                delete created;
+            }
+            if (site->Matches(location, elem_size)) {
+                return site;
+            }
+        }
+        return &overflow_;
+    }
+
+    // Включает подсказки вместимости для первого роста. По умолчанию только собирается профиль
+    void EnableHints(bool enabled) noexcept {
+        hints_enabled_.store(enabled, std::memory_order_relaxed);
+    }
+
+    bool HintsEnabled() const noexcept {
+        return hints_enabled_.load(std::memory_order_relaxed);
+    }
+
+    // Вызывает f(const VectorProfileSite&) для каждого встреченного места
+    template <typename F>
+    void ForEach(F f) const {
+        for (const auto& slot : slots_) {
+            if (const VectorProfileSite* site = slot.load(std::memory_order_acquire)) {
+                f(*site);
+            }
+        }
+        if (overflow_.Read().vectors != 0) {
+            f(overflow_);
+        }
+    }
+
+    void Reset() noexcept {
+        for (auto& slot : slots_) {
+            if (VectorProfileSite* site = slot.load(std::memory_order_acquire)) {
+                site->Reset();
+            }
+        }
+        overflow_.Reset();
+    }
+
+    // Выводит по строке на место в формате "key=value", начиная с мест, дольше всех занятых
+    // реаллокациями. sizes - гистограмма размеров до последней непустой корзины
+    void Dump(std::ostream& out) const {
+        std::vector<std::pair<const VectorProfileSite*, VectorProfileSite::Snapshot>> sites;
+        ForEach([&sites](const VectorProfileSite& site) {
+            sites.emplace_back(&site, site.Read());
+        });
+        std::stable_sort(sites.begin(), sites.end(), [](const auto& lhs, const auto& rhs) {
+            return lhs.second.reallocation_ns > rhs.second.reallocation_ns;
+        });
+        for (const auto& [site, s] : sites) {
+            out << "site=" << site->location.file << ':' << site->location.line << ':' << site->location.column
+                << " function=" << site->location.function
+                << " elem_size=" << site->elem_size
+                << " vectors=" << s.vectors
+                << " destroyed=" << s.destroyed
+                << " reallocations=" << s.reallocations
+                << " reallocation_ns=" << s.reallocation_ns
+                << " elements_relocated=" << s.elements_relocated
+                << " max_size=" << s.max_size
+                << " capacity_hint=" << s.capacity_hint
+                << " sizes=";
+            const size_t last = static_cast<size_t>(
+                std::find_if(s.size_histogram.rbegin(), s.size_histogram.rend(), [](size_t n) { return n != 0; })
+                - s.size_histogram.rbegin());
+            for (size_t i = 0; i < VectorProfileSite::SIZE_BUCKETS - last; ++i) {
+                out << (i == 0 ? "" : ",") << s.size_histogram[i];
+            }
+            out << '\n';
+        }
+    }
+
+private:
+    std::array<std::atomic<VectorProfileSite*>, MAX_SITES> slots_{};
+    VectorProfileSite overflow_{ VectorSourceLocation{ "<other>", "", 0, 0 }, 1 };
+    std::atomic<bool> hints_enabled_{ false };
+
+    VectorProfiler() = default;
+
+    static size_t Hash(const VectorSourceLocation& location, size_t elem_size) noexcept {
+        // FNV-1a по имени файла, строке, столбцу и размеру элемента
+        uint64_t hash = 14695981039346656037ULL;
+        const auto mix = [&hash](uint64_t value) {
+            hash = (hash ^ value) * 1099511628211ULL;
+        };
+        for (const char* c = location.file; *c != '\0'; ++c) {
+            mix(static_cast<unsigned char>(*c));
+        }
+        mix(location.line);
+        mix(location.column);
+        mix(elem_size);
+        return static_cast<size_t>(hash);
+    }
+};
+
+// Измеряет реаллокацию от создания до разрушения и относит её к месту вектора.
+// При вычислениях во время компиляции места нет и таймер ничего не делает
+class VectorReallocationTimer {
+public:
+    VECTOR_CONSTEXPR VectorReallocationTimer(VectorProfileSite* site, size_t relocated) noexcept
+        : site_(site)
+        , relocated_(relocated) {
+        if (site_ != nullptr) {
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+
+    VectorReallocationTimer(const VectorReallocationTimer&) = delete;
+    VectorReallocationTimer& operator=(const VectorReallocationTimer&) = delete;
+
+    VECTOR_CONSTEXPR ~VectorReallocationTimer() {
+        if (site_ != nullptr) {
+            const auto elapsed = std::chrono::steady_clock::now() - start_;
+            site_->OnReallocate(relocated_,
+                                static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        }
+    }
+
+private:
+    VectorProfileSite* site_;
+    size_t relocated_;
+    std::chrono::steady_clock::time_point start_{};
+};
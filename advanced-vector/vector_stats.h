@@ -0,0 +1,167 @@
+#pragma once
+
+// Счётчики выделений памяти и роста Vector. Подключается из vector.h, только если определён
+// макрос VECTOR_ENABLE_STATS. Без него обращения к счётчикам не компилируются вовсе
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <ostream>
+#include <typeinfo>
+#include <vector>
+
+// Счётчики для одного типа элементов. Обновляются атомарно и могут читаться из другого потока
+struct VectorStats {
+    // Заполненность (size / capacity) разрушаемых векторов по корзинам шириной 10%.
+    // Последняя корзина - полностью заполненные векторы
+    static constexpr size_t HISTOGRAM_BUCKETS = 11;
+
+    // Неатомарный снимок счётчиков
+    struct Snapshot {
+        size_t allocations = 0;
+        size_t bytes_allocated = 0;
+        size_t reallocations = 0;
+        size_t in_place_growths = 0;
+        size_t elements_relocated = 0;
+        size_t peak_capacity = 0;
+        std::array<size_t, HISTOGRAM_BUCKETS> utilization_histogram{};
+    };
+
+    explicit VectorStats(const char* type_name) noexcept
+        : type_name(type_name) {
+    }
+
+    void OnAllocate(size_t capacity, size_t elem_size) noexcept {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        bytes_allocated.fetch_add(capacity * elem_size, std::memory_order_relaxed);
+        UpdatePeak(capacity);
+    }
+
+    // Буфер вырос без переноса элементов конструкторами (try_expand или reallocate)
+    void OnGrowInPlace(size_t capacity) noexcept {
+        in_place_growths.fetch_add(1, std::memory_order_relaxed);
+        UpdatePeak(capacity);
+    }
+
+    // Элементы перенесены в новый буфер
+    void OnRelocate(size_t count) noexcept {
+        reallocations.fetch_add(1, std::memory_order_relaxed);
+        elements_relocated.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    void OnDestroy(size_t size, size_t capacity) noexcept {
+        if (capacity != 0) {
+            utilization_histogram[size * (HISTOGRAM_BUCKETS - 1) / capacity].fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    Snapshot Read() const noexcept {
+        Snapshot snapshot;
+        snapshot.allocations = allocations.load(std::memory_order_relaxed);
+        snapshot.bytes_allocated = bytes_allocated.load(std::memory_order_relaxed);
+        snapshot.reallocations = reallocations.load(std::memory_order_relaxed);
+        snapshot.in_place_growths = in_place_growths.load(std::memory_order_relaxed);
+        snapshot.elements_relocated = elements_relocated.load(std::memory_order_relaxed);
+        snapshot.peak_capacity = peak_capacity.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < HISTOGRAM_BUCKETS; ++i) {
+            snapshot.utilization_histogram[i] = utilization_histogram[i].load(std::memory_order_relaxed);
+        }
+        return snapshot;
+    }
+
+    void Reset() noexcept {
+        allocations = 0;
+        bytes_allocated = 0;
+        reallocations = 0;
+        in_place_growths = 0;
+        elements_relocated = 0;
+        peak_capacity = 0;
+        for (auto& bucket : utilization_histogram) {
+            bucket = 0;
+        }
+    }
+
+    const char* type_name;
+    std::atomic<size_t> allocations{ 0 };
+    std::atomic<size_t> bytes_allocated{ 0 };
+    std::atomic<size_t> reallocations{ 0 };
+    std::atomic<size_t> in_place_growths{ 0 };
+    std::atomic<size_t> elements_relocated{ 0 };
+    std::atomic<size_t> peak_capacity{ 0 };
+    std::array<std::atomic<size_t>, HISTOGRAM_BUCKETS> utilization_histogram{};
+
+private:
+    void UpdatePeak(size_t capacity) noexcept {
+        size_t peak = peak_capacity.load(std::memory_order_relaxed);
+        while (peak < capacity && !peak_capacity.compare_exchange_weak(peak, capacity, std::memory_order_relaxed)) {
+        }
+    }
+};
+
+// Реестр счётчиков всех типов элементов, встречавшихся в программе
+class VectorStatsRegistry {
+public:
+    static VectorStatsRegistry& Instance() {
+        static VectorStatsRegistry registry;
+        return registry;
+    }
+
+    void Register(VectorStats* stats) {
+        std::lock_guard lock(mutex_);
+        stats_.push_back(stats);
+    }
+
+    // Вызывает f(const VectorStats&) для каждого зарегистрированного типа
+    template <typename F>
+    void ForEach(F f) const {
+        std::lock_guard lock(mutex_);
+        for (const VectorStats* stats : stats_) {
+            f(*stats);
+        }
+    }
+
+    void Reset() {
+        std::lock_guard lock(mutex_);
+        for (VectorStats* stats : stats_) {
+            stats->Reset();
+        }
+    }
+
+    // Выводит по строке на тип в формате "key=value"
+    void Dump(std::ostream& out) const {
+        ForEach([&out](const VectorStats& stats) {
+            const VectorStats::Snapshot s = stats.Read();
+            out << "type=" << stats.type_name
+                << " allocations=" << s.allocations
+                << " bytes_allocated=" << s.bytes_allocated
+                << " reallocations=" << s.reallocations
+                << " in_place_growths=" << s.in_place_growths
+                << " elements_relocated=" << s.elements_relocated
+                << " peak_capacity=" << s.peak_capacity
+                << " utilization=";
+            for (size_t i = 0; i < VectorStats::HISTOGRAM_BUCKETS; ++i) {
+                out << (i == 0 ? "" : ",") << s.utilization_histogram[i];
+            }
+            out << '\n';
+        });
+    }
+
+private:
+    VectorStatsRegistry() = default;
+
+    mutable std::mutex mutex_;
+    std::vector<VectorStats*> stats_;
+};
+
+// Счётчики для типа элементов T. Регистрируются в реестре при первом обращении
+template <typename T>
+VectorStats& GetVectorStats() {
+    static VectorStats* stats = [] {
+        static VectorStats instance(typeid(T).name());
+        VectorStatsRegistry::Instance().Register(&instance);
+        return &instance;
+    }();
+    return *stats;
+}
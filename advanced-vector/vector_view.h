@@ -0,0 +1,330 @@
+#pragma once
+
+// Невладеющие представления участков непрерывной памяти. Не выделяют память и не копируют элементы.
+// Доступ по индексу и границы подучастков проверяются VECTOR_CHECK: в отладочной сборке
+// и в усиленном режиме (см. vector_check.h)
+
+#include "vector_check.h"
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+#if __cplusplus >= 202002L && __has_include(<span>)
+#include <span>
+#endif
+
+// Непрерывный участок [data, data + size). Итераторы - указатели, как и у Vector
+template <typename T>
+class VectorView {
+public:
+    using element_type = T;
+    using value_type = std::remove_cv_t<T>;
+    using iterator = T*;
+
+    static constexpr size_t NPOS = static_cast<size_t>(-1);
+
+    constexpr VectorView() noexcept = default;
+
+    constexpr VectorView(T* data, size_t size) noexcept
+        : data_(data)
+        , size_(size) {
+    }
+
+    // Представление изменяемых элементов неявно приводится к представлению константных
+    template <typename U, typename = std::enable_if_t<std::is_convertible_v<U (*)[], T (*)[]>>>
+    constexpr VectorView(const VectorView<U>& other) noexcept
+        : data_(other.Data())
+        , size_(other.Size()) {
+    }
+
+#if __cplusplus >= 202002L && defined(__cpp_lib_span)
+    constexpr operator std::span<T>() const noexcept {
+        return std::span<T>(data_, size_);
+    }
+#endif
+
+    constexpr T* begin() const noexcept {
+        return data_;
+    }
+    constexpr T* end() const noexcept {
+        return data_ + size_;
+    }
+
+    constexpr T* Data() const noexcept {
+        return data_;
+    }
+
+    constexpr size_t Size() const noexcept {
+        return size_;
+    }
+
+    constexpr bool Empty() const noexcept {
+        return size_ == 0;
+    }
+
+    constexpr T& operator[](size_t index) const noexcept {
+        VECTOR_CHECK(index < size_);
+        return data_[index];
+    }
+
+    // count элементов начиная с offset, по умолчанию - до конца
+    constexpr VectorView Subspan(size_t offset, size_t count = NPOS) const noexcept {
+        VECTOR_CHECK(offset <= size_);
+        if (count == NPOS) {
+            count = size_ - offset;
+        }
+        VECTOR_CHECK(count <= size_ - offset);
+        return VectorView(data_ + offset, count);
+    }
+
+    constexpr VectorView First(size_t count) const noexcept {
+        return Subspan(0, count);
+    }
+
+    constexpr VectorView Last(size_t count) const noexcept {
+        VECTOR_CHECK(count <= size_);
+        return Subspan(size_ - count, count);
+    }
+
+    // Каждый stride-й элемент, начиная с первого
+    constexpr auto Strided(size_t stride) const noexcept;
+
+    // Последовательные участки по count элементов, последний может быть короче.
+    // При count == 0 участков нет
+    constexpr auto Chunks(size_t count) const noexcept;
+
+private:
+    T* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+// Элементы data[0], data[stride], data[2 * stride], ... - например, один столбец матрицы,
+// хранящейся по строкам
+template <typename T>
+class StridedView {
+public:
+    // Хранит начало участка и номер элемента, так что end() не выходит за пределы участка
+    class Iterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = std::remove_cv_t<T>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = T*;
+        using reference = T&;
+
+        constexpr Iterator() noexcept = default;
+        constexpr Iterator(T* data, size_t stride, size_t index) noexcept
+            : data_(data)
+            , stride_(stride)
+            , index_(index) {
+        }
+
+        constexpr T& operator*() const noexcept {
+            return data_[index_ * stride_];
+        }
+        constexpr T* operator->() const noexcept {
+            return data_ + index_ * stride_;
+        }
+        constexpr T& operator[](difference_type n) const noexcept {
+            return data_[(index_ + n) * stride_];
+        }
+
+        constexpr Iterator& operator++() noexcept {
+            ++index_;
+            return *this;
+        }
+        constexpr Iterator operator++(int) noexcept {
+            Iterator old = *this;
+            ++index_;
+            return old;
+        }
+        constexpr Iterator& operator--() noexcept {
+            --index_;
+            return *this;
+        }
+        constexpr Iterator operator--(int) noexcept {
+            Iterator old = *this;
+            --index_;
+            return old;
+        }
+        constexpr Iterator& operator+=(difference_type n) noexcept {
+            index_ += n;
+            return *this;
+        }
+        constexpr Iterator& operator-=(difference_type n) noexcept {
+            index_ -= n;
+            return *this;
+        }
+        friend constexpr Iterator operator+(Iterator it, difference_type n) noexcept {
+            return it += n;
+        }
+        friend constexpr Iterator operator+(difference_type n, Iterator it) noexcept {
+            return it += n;
+        }
+        friend constexpr Iterator operator-(Iterator it, difference_type n) noexcept {
+            return it -= n;
+        }
+        friend constexpr difference_type operator-(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+        }
+
+        friend constexpr bool operator==(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return lhs.index_ == rhs.index_;
+        }
+        friend constexpr bool operator!=(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return lhs.index_ != rhs.index_;
+        }
+        friend constexpr bool operator<(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return lhs.index_ < rhs.index_;
+        }
+        friend constexpr bool operator>(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return lhs.index_ > rhs.index_;
+        }
+        friend constexpr bool operator<=(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return lhs.index_ <= rhs.index_;
+        }
+        friend constexpr bool operator>=(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return lhs.index_ >= rhs.index_;
+        }
+
+    private:
+        T* data_ = nullptr;
+        size_t stride_ = 1;
+        size_t index_ = 0;
+    };
+
+    using iterator = Iterator;
+
+    constexpr StridedView() noexcept = default;
+
+    // Элементы из участка [data, data + span_size) с шагом stride
+    constexpr StridedView(T* data, size_t span_size, size_t stride) noexcept
+        : data_(data)
+        , size_(CountOf(span_size, stride))
+        , stride_(stride) {
+    }
+
+    constexpr Iterator begin() const noexcept {
+        return Iterator(data_, stride_, 0);
+    }
+    constexpr Iterator end() const noexcept {
+        return Iterator(data_, stride_, size_);
+    }
+
+    constexpr size_t Size() const noexcept {
+        return size_;
+    }
+
+    constexpr size_t Stride() const noexcept {
+        return stride_;
+    }
+
+    constexpr T& operator[](size_t index) const noexcept {
+        VECTOR_CHECK(index < size_);
+        return data_[index * stride_];
+    }
+
+private:
+    T* data_ = nullptr;
+    size_t size_ = 0;
+    size_t stride_ = 1;
+
+    // Шаг проверяется до деления: при нулевом шаге без проверок представление пусто
+    static constexpr size_t CountOf(size_t span_size, size_t stride) noexcept {
+        VECTOR_CHECK(stride > 0);
+        return span_size == 0 || stride == 0 ? 0 : (span_size - 1) / stride + 1;
+    }
+};
+
+// Диапазон последовательных участков по chunk элементов. Элемент диапазона - VectorView
+template <typename T>
+class ChunkRange {
+public:
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = VectorView<T>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = VectorView<T>;
+
+        constexpr Iterator() noexcept = default;
+        constexpr Iterator(T* ptr, T* end, size_t chunk) noexcept
+            : ptr_(ptr)
+            , end_(end)
+            , chunk_(chunk) {
+        }
+
+        constexpr VectorView<T> operator*() const noexcept {
+            const size_t left = static_cast<size_t>(end_ - ptr_);
+            return VectorView<T>(ptr_, left < chunk_ ? left : chunk_);
+        }
+
+        constexpr Iterator& operator++() noexcept {
+            const size_t left = static_cast<size_t>(end_ - ptr_);
+            ptr_ += left < chunk_ ? left : chunk_;
+            return *this;
+        }
+        constexpr Iterator operator++(int) noexcept {
+            Iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        friend constexpr bool operator==(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return lhs.ptr_ == rhs.ptr_;
+        }
+        friend constexpr bool operator!=(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return lhs.ptr_ != rhs.ptr_;
+        }
+
+    private:
+        T* ptr_ = nullptr;
+        T* end_ = nullptr;
+        size_t chunk_ = 1;
+    };
+
+    using iterator = Iterator;
+
+    // Нулевой размер участка даёт пустой диапазон: ни Size(), ни итераторы не делят на ноль
+    // и не зацикливаются
+    constexpr ChunkRange(T* data, size_t size, size_t chunk) noexcept
+        : data_(data)
+        , size_(chunk == 0 ? 0 : size)
+        , chunk_(chunk == 0 ? 1 : chunk) {
+    }
+
+    constexpr Iterator begin() const noexcept {
+        return Iterator(data_, data_ + size_, chunk_);
+    }
+    constexpr Iterator end() const noexcept {
+        return Iterator(data_ + size_, data_ + size_, chunk_);
+    }
+
+    // Количество участков
+    constexpr size_t Size() const noexcept {
+        return (size_ + chunk_ - 1) / chunk_;
+    }
+
+    constexpr VectorView<T> operator[](size_t index) const noexcept {
+        VECTOR_CHECK(index < Size());
+        const size_t offset = index * chunk_;
+        return VectorView<T>(data_ + offset, size_ - offset < chunk_ ? size_ - offset : chunk_);
+    }
+
+private:
+    T* data_;
+    size_t size_;
+    size_t chunk_;
+};
+
+template <typename T>
+constexpr auto VectorView<T>::Strided(size_t stride) const noexcept {
+    return StridedView<T>(data_, size_, stride);
+}
+
+template <typename T>
+constexpr auto VectorView<T>::Chunks(size_t count) const noexcept {
+    return ChunkRange<T>(data_, size_, count);
+}